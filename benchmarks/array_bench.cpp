@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <vector>
+#include "pigeon_framework/base/container/array.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+template <typename V>
+void PushBack(V& values, int64_t val) {
+  if constexpr (requires { values.PushBack(val); }) {
+    values.PushBack(val);
+  } else {
+    values.push_back(val);
+  }
+}
+
+template <typename V>
+void BM_PushBack(benchmark::State& state) {
+  for (auto _ : state) {
+    V values;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      PushBack(values, i);
+    }
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename V>
+void BM_Reserved(benchmark::State& state) {
+  for (auto _ : state) {
+    V values;
+    if constexpr (requires { values.Reserve(0); }) {
+      values.Reserve(state.range(0));
+    } else {
+      values.reserve(state.range(0));
+    }
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      PushBack(values, i);
+    }
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Inserts and removes at the front, which shifts every element.
+void BM_ArrayInsertRemoveFront(benchmark::State& state) {
+  Array<int64_t> values;
+  values.Resize(state.range(0));
+  for (auto _ : state) {
+    values.Insert(0, 1);
+    benchmark::DoNotOptimize(values.Remove(0));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_VectorInsertRemoveFront(benchmark::State& state) {
+  std::vector<int64_t> values(state.range(0));
+  for (auto _ : state) {
+    values.insert(values.begin(), 1);
+    values.erase(values.begin());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ArraySwapRemove(benchmark::State& state) {
+  Array<int64_t> values;
+  values.Resize(state.range(0));
+  for (auto _ : state) {
+    values.PushBack(1);
+    benchmark::DoNotOptimize(values.SwapRemove(0));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ArrayFind(benchmark::State& state) {
+  Array<int32_t> values;
+  for (int32_t i = 0; i < state.range(0); ++i) {
+    values.PushBack(i);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(values.Contains(-1));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_PushBack<Array<int64_t>>)->Range(8, 1 << 16);
+BENCHMARK(BM_PushBack<std::vector<int64_t>>)->Range(8, 1 << 16);
+BENCHMARK(BM_PushBack<InlineArray<int64_t, 16>>)->Range(8, 1 << 16);
+BENCHMARK(BM_Reserved<Array<int64_t>>)->Range(8, 1 << 16);
+BENCHMARK(BM_Reserved<std::vector<int64_t>>)->Range(8, 1 << 16);
+BENCHMARK(BM_ArrayInsertRemoveFront)->Range(8, 1 << 14);
+BENCHMARK(BM_VectorInsertRemoveFront)->Range(8, 1 << 14);
+BENCHMARK(BM_ArraySwapRemove)->Range(8, 1 << 14);
+BENCHMARK(BM_ArrayFind)->Range(8, 1 << 14);
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <memory>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/auto_ptr/shared.hpp"
+#include "pigeon_framework/base/auto_ptr/unretained.hpp"
+#include "pigeon_framework/base/memory/object_pool.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+void BM_OwnedNew(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ptr = Owned<int64_t>::New(1);
+    benchmark::DoNotOptimize(ptr.Get());
+  }
+}
+
+void BM_OwnedNewPooled(benchmark::State& state) {
+  ObjectPool<int64_t> pool;
+  for (auto _ : state) {
+    auto ptr = pool.New(1);
+    benchmark::DoNotOptimize(ptr.Get());
+  }
+}
+
+void BM_UniquePtrNew(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ptr = std::make_unique<int64_t>(1);
+    benchmark::DoNotOptimize(ptr.get());
+  }
+}
+
+template <typename P>
+void BM_SharedNew(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ptr = P::New(1);
+    benchmark::DoNotOptimize(ptr.Get());
+  }
+}
+
+void BM_SharedAsyncNewPooled(benchmark::State& state) {
+  ObjectPool<int64_t> pool;
+  for (auto _ : state) {
+    auto ptr = pool.NewShared(1);
+    benchmark::DoNotOptimize(ptr.Get());
+  }
+}
+
+void BM_StdSharedNew(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ptr = std::make_shared<int64_t>(1);
+    benchmark::DoNotOptimize(ptr.get());
+  }
+}
+
+void BM_SharedLocalClone(benchmark::State& state) {
+  auto ptr = SharedLocal<int64_t>::New(1);
+  for (auto _ : state) {
+    auto cloned = ptr.Clone();
+    benchmark::DoNotOptimize(cloned.Get());
+  }
+}
+
+// All threads clone the same pointer, so they contend on one counter.
+SharedAsync<int64_t> shared_ptr;
+Unretained<int64_t, ThreadSafeRefCount> unretained_ptr;
+
+void BM_SharedAsyncClone(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_ptr = SharedAsync<int64_t>::New(1);
+  }
+  for (auto _ : state) {
+    auto cloned = shared_ptr.Clone();
+    benchmark::DoNotOptimize(cloned.Get());
+  }
+  if (state.thread_index() == 0) {
+    shared_ptr = SharedAsync<int64_t>();
+  }
+}
+
+void BM_StdSharedCopy(benchmark::State& state) {
+  static std::shared_ptr<int64_t> ptr;
+  if (state.thread_index() == 0) {
+    ptr = std::make_shared<int64_t>(1);
+  }
+  for (auto _ : state) {
+    auto copied = ptr;
+    benchmark::DoNotOptimize(copied.get());
+  }
+  if (state.thread_index() == 0) {
+    ptr.reset();
+  }
+}
+
+void BM_UnretainedUpgrade(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_ptr = SharedAsync<int64_t>::New(1);
+    unretained_ptr = Unretained<int64_t, ThreadSafeRefCount>(shared_ptr);
+  }
+  for (auto _ : state) {
+    auto upgraded = unretained_ptr.TryUpgrade();
+    benchmark::DoNotOptimize(upgraded.Get());
+  }
+  if (state.thread_index() == 0) {
+    unretained_ptr = Unretained<int64_t, ThreadSafeRefCount>();
+    shared_ptr = SharedAsync<int64_t>();
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_OwnedNew);
+BENCHMARK(BM_OwnedNewPooled)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_UniquePtrNew);
+BENCHMARK(BM_SharedNew<SharedLocal<int64_t>>);
+BENCHMARK(BM_SharedNew<SharedAsync<int64_t>>);
+BENCHMARK(BM_SharedAsyncNewPooled)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_StdSharedNew);
+BENCHMARK(BM_SharedLocalClone);
+BENCHMARK(BM_SharedAsyncClone)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_StdSharedCopy)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_UnretainedUpgrade)->ThreadRange(1, 8)->UseRealTime();
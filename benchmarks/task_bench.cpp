@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/task/parallel_tasks.hpp"
+#include "pigeon_framework/task/serial_tasks.hpp"
+#include "pigeon_framework/task/task.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+// Does `work` steps of arithmetic per Execute and never finishes.
+class SpinTask : public Task {
+ public:
+  explicit SpinTask(int64_t work) : work_(work) {}
+
+  Status Execute() override {
+    for (int64_t i = 0; i < work_; ++i) {
+      val_ = val_ * 31 + i;
+    }
+    benchmark::DoNotOptimize(val_);
+    return Keep;
+  }
+
+ private:
+  int64_t work_;
+  int64_t val_{0};
+};
+
+// One Execute of the executor runs every task once, so items are tasks.
+template <typename Tasks>
+void BM_Execute(benchmark::State& state) {
+  Tasks tasks;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    tasks.Push(Owned<SpinTask>::New(state.range(1)));
+  }
+  for (auto _ : state) {
+    tasks.Execute();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Pushes short-lived tasks every iteration, measuring the bookkeeping.
+class OnceTask : public Task {
+ public:
+  Status Execute() override { return Done; }
+};
+
+void BM_SerialChurn(benchmark::State& state) {
+  SerialTasks tasks;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      tasks.Push(Owned<OnceTask>::New());
+    }
+    tasks.Execute();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Execute<SerialTasks>)
+    ->ArgsProduct({{1, 16, 256, 4096}, {0, 1000}});
+BENCHMARK(BM_Execute<ParallelTasks>)
+    ->ArgsProduct({{1, 16, 256, 4096}, {0, 1000}})
+    ->UseRealTime();
+BENCHMARK(BM_SerialChurn)->Range(1, 4096);
@@ -1,8 +1,31 @@
 #include <iostream>
+#include "pigeon_framework/application.hpp"
 
 using namespace std;
+using namespace pigeon;
+
+class HelloTask : public Task {
+ public:
+  explicit HelloTask(Application* app) : app_(app) {}
+
+  Status Execute() override {
+    cout << "hello world! frame " << app_->FrameCnt() << endl;
+    if (app_->FrameCnt() == 2) {
+      app_->Stop();
+      return Status::Done;
+    }
+    return Status::Keep;
+  }
+
+ private:
+  Application* app_;
+};
 
 int main(int argc, char** argv) {
-  cout << "hello world!" << endl;
+  Application::Config config;
+  config.min_frame_time_ = chrono::milliseconds(16);
+  Application app(config);
+  app.PushFrame(Owned<HelloTask>::New(&app));
+  app.Run();
   return 0;
 }
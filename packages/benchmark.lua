@@ -0,0 +1,51 @@
+package("benchmark")
+  set_homepage("https://github.com/google/benchmark")
+  set_description("A microbenchmark support library.")
+
+  add_urls("https://github.com/google/benchmark.git")
+  add_versions("1.8.3", "v1.8.3")
+
+  add_deps("cmake")
+
+  add_configs("main", {
+      description = "Link to the benchmark_main entry point.",
+      default = false,
+      type = "boolean"
+  })
+
+  if is_plat("linux") then
+    add_syslinks("pthread", "rt")
+  elseif is_plat("windows") then
+    add_syslinks("shlwapi")
+    add_defines("BENCHMARK_STATIC_DEFINE")
+  end
+
+  on_load(function (package)
+    if package:config("main") then
+      package:add("links", "benchmark_main", "benchmark")
+    else
+      package:add("links", "benchmark")
+    end
+  end)
+
+  on_install(function (package)
+    local configs = {
+      "-DBENCHMARK_ENABLE_TESTING=OFF",
+      "-DBENCHMARK_ENABLE_GTEST_TESTS=OFF",
+      "-DBENCHMARK_ENABLE_WERROR=OFF",
+      "-DBUILD_SHARED_LIBS=OFF",
+      "-DCMAKE_BUILD_TYPE=Release"
+    }
+    import("package.tools.cmake").install(package, configs)
+  end)
+
+  on_test(function (package)
+    assert(package:check_cxxsnippets({test = [[
+      static void BM_Empty(benchmark::State& state) {
+        for (auto _ : state) {
+          benchmark::DoNotOptimize(state.iterations());
+        }
+      }
+      BENCHMARK(BM_Empty);
+    ]]}, {configs = {languages = "c++14"}, includes = "benchmark/benchmark.h"}))
+  end)
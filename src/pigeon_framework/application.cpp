@@ -1 +1,109 @@
 #include "pigeon_framework/application.hpp"
+
+#include <algorithm>
+#include <thread>
+#include "pigeon_framework/base/memory/frame_arena.hpp"
+#include "pigeon_framework/base/profile/profiler.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+[[maybe_unused]] constexpr const char* kPriorityZones[] = {
+    "Application::High", "Application::Normal", "Application::Low"};
+
+}  // namespace
+
+Application::Application(const Config& config)
+    : config_(config), timers_(config.timer_resolution_) {
+  config_.fixed_step_ = std::max(config_.fixed_step_, Clock::duration(1));
+  FrameArena::Claim(this);
+}
+
+Application::~Application() { FrameArena::Release(this); }
+
+void Application::PushFixed(Owned<Task>&& task) {
+  fixed_tasks_.Push(std::move(task));
+}
+
+void Application::PushFrame(Owned<Task>&& task, Priority priority) {
+  frame_tasks_[static_cast<size_t>(priority)].Push(std::move(task));
+}
+
+void Application::Run() {
+  OnStart();
+  try {
+    while (!stop_.load(std::memory_order_acquire)) {
+      Clock::time_point start = Clock::now();
+      Tick(start);
+      if (config_.min_frame_time_ > Clock::duration::zero()) {
+        std::this_thread::sleep_until(start + config_.min_frame_time_);
+      }
+    }
+  } catch (...) {
+    stop_.store(false, std::memory_order_relaxed);
+    OnStop();
+    throw;
+  }
+  // Reset on the way out, a Stop before Run still ends it.
+  stop_.store(false, std::memory_order_relaxed);
+  OnStop();
+}
+
+void Application::Tick(Clock::time_point now) {
+  PIGEON_PROFILE_ZONE("Application::Tick");
+  uint64_t alloc_cnt = MemoryTracker::kEnabled ? MemoryTracker::AllocCnt() : 0;
+  MemoryTagScope scope(kMemoryTagTasks);
+  TimerWheelScope wheel_scope(&timers_);
+  FrameArena::NextFrame();
+  Clock::time_point start = Clock::now();
+  if (!started_) {
+    started_ = true;
+    last_frame_ = now;
+  }
+  frame_time_ = std::max(now - last_frame_, Clock::duration::zero());
+  last_frame_ = now;
+
+  size_t posted_cnt = config_.max_posted_cnt_;
+  for (size_t i = 0; i < kPriorityCnt; ++i) {
+    auto push = [this, i](Owned<Task>&& task) {
+      frame_tasks_[i].Push(std::move(task));
+    };
+    posted_cnt -= inboxes_[i].Drain(push, posted_cnt);
+  }
+
+  Clock::duration max_lag = config_.fixed_step_ * config_.max_fixed_step_cnt_;
+  lag_ = std::min(lag_ + frame_time_, max_lag);
+  while (lag_ >= config_.fixed_step_) {
+    PIGEON_PROFILE_ZONE("Application::FixedStep");
+    fixed_tasks_.Execute();
+    lag_ -= config_.fixed_step_;
+    ++fixed_step_cnt_;
+  }
+
+  {
+    PIGEON_PROFILE_ZONE("Application::Timers");
+    MemoryTagScope timers_scope(kMemoryTagTimers);
+    timers_.Advance(now);
+  }
+
+  for (size_t i = 0; i < kPriorityCnt; ++i) {
+    if (i != 0 && !deferred_[i] &&
+        Clock::now() - start > config_.frame_budget_) {
+      deferred_[i] = true;
+      continue;
+    }
+    deferred_[i] = false;
+    PIGEON_PROFILE_ZONE(kPriorityZones[i]);
+    frame_tasks_[i].Execute();
+  }
+  ++frame_cnt_;
+  if constexpr (MemoryTracker::kEnabled) {
+    tick_alloc_cnt_ = MemoryTracker::AllocCnt() - alloc_cnt;
+  }
+}
+
+double Application::Alpha() const {
+  return std::chrono::duration<double>(lag_) /
+         std::chrono::duration<double>(config_.fixed_step_);
+}
@@ -1,13 +1,123 @@
 #ifndef PIGEON_FRAMEWORK_APPLICATION
 #define PIGEON_FRAMEWORK_APPLICATION
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
 #include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/serial_tasks.hpp"
+#include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/task_inbox.hpp"
+#include "pigeon_framework/task/timer_wheel.hpp"
 
 namespace pigeon {
 
+// Main loop owning the root tasks. Every frame it takes in the tasks posted
+// from other threads, runs the fixed tasks once per elapsed fixed step, fires
+// the timers, then runs the frame tasks by priority. Once a frame has used up
+// its budget, the remaining priorities below High are deferred to the next
+// frame, where they run regardless of the budget so that nothing starves.
+// Each frame also starts a new FrameArena frame for per-frame scratch data,
+// which is why only one Application may exist at a time.
 class PIGEON_API Application {
  public:
-  Application() = default;
+  using Clock = std::chrono::steady_clock;
+
+  enum class Priority { High, Normal, Low };
+  static constexpr size_t kPriorityCnt = 3;
+
+  struct Config {
+    Clock::duration fixed_step_{std::chrono::nanoseconds(1000000000 / 60)};
+    // Fixed steps caught up per frame at most, the rest of a long frame is
+    // dropped rather than slowing down every frame after it.
+    size_t max_fixed_step_cnt_{8};
+    Clock::duration frame_budget_{std::chrono::milliseconds(16)};
+    // Run sleeps out frames shorter than this, zero runs flat out.
+    Clock::duration min_frame_time_{0};
+    Clock::duration timer_resolution_{std::chrono::milliseconds(1)};
+    // Posted tasks taken per frame at most, so that a flood of posts can't
+    // hold up the loop.
+    size_t max_posted_cnt_{4096};
+  };
+
+  Application() : Application(Config()) {}
+  explicit Application(const Config& config);
+  virtual ~Application();
+
+  Application(const Application& other) = delete;
+  Application& operator=(const Application& other) = delete;
+
+  void PushFixed(Owned<Task>&& task);
+  void PushFrame(Owned<Task>&& task, Priority priority = Priority::Normal);
+
+  // Like PushFrame, but from any thread. The task joins at the start of the
+  // next frame.
+  void PostTask(Owned<Task>&& task, Priority priority = Priority::Normal) {
+    inboxes_[static_cast<size_t>(priority)].Post(std::move(task));
+  }
+
+  TimerWheel& Timers() { return timers_; }
+
+  // Runs frames until Stop, between OnStart and OnStop. Returns without a
+  // frame if Stop was called before.
+  void Run();
+
+  // May be called from any thread, the current frame is finished first.
+  void Stop() { stop_.store(true, std::memory_order_release); }
+
+  // One frame at `now`, for embedding the loop somewhere else.
+  void Tick(Clock::time_point now);
+
+  uint64_t FrameCnt() const { return frame_cnt_; }
+
+  uint64_t FixedStepCnt() const { return fixed_step_cnt_; }
+
+  // Time between the last two frames.
+  Clock::duration FrameTime() const { return frame_time_; }
+
+  // How far the last frame is into the next fixed step, in [0, 1), to
+  // interpolate rendering between simulation states.
+  double Alpha() const;
+
+  bool IsDeferred(Priority priority) const {
+    return deferred_[static_cast<size_t>(priority)];
+  }
+
+  const Config& GetConfig() const { return config_; }
+
+  // Heap allocations made during the last frame on any thread, always zero
+  // without memory tracking, see memory_tracker.hpp.
+  uint64_t TickAllocCnt() const { return tick_alloc_cnt_; }
+
+  MemoryStats GetMemoryStats(MemoryTag tag) const {
+    return MemoryTracker::Stats(tag);
+  }
+
+  std::string DumpMemoryStats() const { return MemoryTracker::Dump(); }
+
+ protected:
+  virtual void OnStart() {}
+  virtual void OnStop() {}
+
+ private:
+  Config config_;
+  SerialTasks fixed_tasks_;
+  SerialTasks frame_tasks_[kPriorityCnt];
+  TaskInbox inboxes_[kPriorityCnt];
+  bool deferred_[kPriorityCnt]{};
+  TimerWheel timers_;
+
+  std::atomic_bool stop_{false};
+  bool started_{false};
+  Clock::time_point last_frame_;
+  Clock::duration frame_time_{0};
+  Clock::duration lag_{0};
+  uint64_t frame_cnt_{0};
+  uint64_t fixed_step_cnt_{0};
+  uint64_t tick_alloc_cnt_{0};
 };
 
 }  // namespace pigeon
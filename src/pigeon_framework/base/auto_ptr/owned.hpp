@@ -1,37 +1,60 @@
 #ifndef PIGEON_FRAMEWORK_BASE_AUTO_PTR_OWNED
 #define PIGEON_FRAMEWORK_BASE_AUTO_PTR_OWNED
 
-#include <functional>
+#include <concepts>
 #include <utility>
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "pigeon_framework/base/memory/relocate.hpp"
 #include "pigeon_framework/define.hpp"
 
-#define INSTANTIATE_OWNED(ValueType)                         \
-  template class PIGEON_API std::function<void(ValueType*)>; \
+#define INSTANTIATE_OWNED(ValueType) \
   template class PIGEON_API pigeon::Owned<ValueType>;
 
 namespace pigeon {
 
 template <typename T>
+struct DefaultDelete {
+  DefaultDelete() = default;
+
+  template <typename U>
+    requires std::convertible_to<U*, T*>
+  DefaultDelete(const DefaultDelete<U>&) {}
+
+  void operator()(T* raw_ptr) const { delete raw_ptr; }
+};
+
+template <typename T, typename D = DefaultDelete<T>>
 class Owned {
  public:
-  using Destructor = std::function<void(T*)>;
-
   Owned() = default;
 
-  explicit Owned(T* raw_ptr, Destructor destructor = DefaultDestructor)
-      : raw_ptr_(raw_ptr), destructor_(destructor) {}
+  explicit Owned(T* raw_ptr, D deleter = D())
+      : raw_ptr_(raw_ptr), deleter_(std::move(deleter)) {}
 
   template <typename... Args>
   static Owned New(Args&&... args) {
-    return Owned(new T(args...));
+    return Owned(new T(std::forward<Args>(args)...));
+  }
+
+  template <AsAllocator A, typename... Args>
+  static Owned<T, AllocatorDelete<T, A>> NewIn(A allocator, Args&&... args) {
+    T* raw_ptr = NewObject<T>(allocator, std::forward<Args>(args)...);
+    return Owned<T, AllocatorDelete<T, A>>(raw_ptr,
+                                           AllocatorDelete<T, A>(allocator));
   }
 
   Owned(const Owned& other) = delete;
 
   Owned(Owned&& other) noexcept
-      : raw_ptr_(other.raw_ptr_), destructor_(other.destructor_) {
+      : raw_ptr_(other.raw_ptr_), deleter_(std::move(other.deleter_)) {
+    other.raw_ptr_ = nullptr;
+  }
+
+  template <typename U, typename E>
+    requires std::convertible_to<U*, T*> && std::constructible_from<D, E&&>
+  Owned(Owned<U, E>&& other) noexcept
+      : raw_ptr_(other.raw_ptr_), deleter_(std::move(other.deleter_)) {
     other.raw_ptr_ = nullptr;
-    other.destructor_ = DefaultDestructor;
   }
 
   Owned& operator=(Owned&& other) noexcept {
@@ -42,7 +65,11 @@ class Owned {
     return *this;
   }
 
-  ~Owned() { destructor_(raw_ptr_); }
+  ~Owned() {
+    if (raw_ptr_ != nullptr) {
+      deleter_(raw_ptr_);
+    }
+  }
 
   T* operator->() const { return raw_ptr_; }
 
@@ -50,15 +77,24 @@ class Owned {
 
   T* Get() const { return raw_ptr_; }
 
+  const D& GetDeleter() const { return deleter_; }
+
+  // Gives up ownership without destroying the object.
+  T* Release() { return std::exchange(raw_ptr_, nullptr); }
+
   bool IsNull() const { return raw_ptr_ == nullptr; }
 
  private:
-  static void DefaultDestructor(T* raw_ptr) { delete raw_ptr; }
+  template <typename U, typename E>
+  friend class Owned;
 
   T* raw_ptr_{nullptr};
-  Destructor destructor_{DefaultDestructor};
+  [[no_unique_address]] D deleter_;
 };
 
+template <typename T, typename D>
+struct IsTriviallyRelocatable<Owned<T, D>> : IsTriviallyRelocatable<D> {};
+
 }  // namespace pigeon
 
 #endif  // PIGEON_FRAMEWORK_BASE_AUTO_PTR_OWNED
@@ -3,101 +3,336 @@
 
 #include <atomic>
 #include <concepts>
-#include <functional>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include "pigeon_framework/base/memory/allocator.hpp"
 #include "pigeon_framework/define.hpp"
 
-#define INSTANTIATE_SHARED_ASYNC(ValueType)                  \
-  template class PIGEON_API std::function<void(ValueType*)>; \
-  template class PIGEON_API                                  \
+#define INSTANTIATE_SHARED_ASYNC(ValueType) \
+  template class PIGEON_API                 \
       pigeon::Shared<ValueType, pigeon::ThreadSafeRefCount>;
 
-#define INSTANTIATE_SHARED_LOCAL(ValueType)                  \
-  template class PIGEON_API std::function<void(ValueType*)>; \
-  template class PIGEON_API                                  \
+#define INSTANTIATE_SHARED_LOCAL(ValueType) \
+  template class PIGEON_API                 \
       pigeon::Shared<ValueType, pigeon::ThreadLocalRefCount>;
 
 namespace pigeon {
 
-struct RefCount {
-  virtual size_t Get() = 0;
-  virtual void Increase() = 0;
-  virtual bool TryDecrease() = 0;
-  virtual ~RefCount() = default;
-};
-
-struct ThreadLocalRefCount : public RefCount {
+// Ref count policies are resolved at compile time. TryIncrease only succeeds
+// while the count is not zero, which is what upgrading an Unretained needs.
+struct ThreadLocalRefCount {
   size_t cnt_{0};
 
-  size_t Get() override { return cnt_; }
+  size_t Get() const { return cnt_; }
+
+  void Increase() { cnt_++; }
 
-  void Increase() override { cnt_++; }
+  bool TryIncrease() {
+    if (cnt_ == 0) {
+      return false;
+    }
+    cnt_++;
+    return true;
+  }
 
-  bool TryDecrease() override {
+  bool TryDecrease() {
     cnt_--;
     return cnt_ == 0 ? false : true;
   }
-
-  ~ThreadLocalRefCount() override = default;
 };
 
-struct ThreadSafeRefCount : public RefCount {
+// A new reference is always taken from an existing one, so increments don't
+// need to order anything. The last decrement acquires every write released by
+// the other owners before the object is destroyed.
+struct ThreadSafeRefCount {
   std::atomic_size_t cnt_{0};
 
-  size_t Get() override { return cnt_.load(); }
+  size_t Get() const { return cnt_.load(std::memory_order_acquire); }
 
-  void Increase() override { cnt_.fetch_add(1); }
+  void Increase() { cnt_.fetch_add(1, std::memory_order_relaxed); }
 
-  bool TryDecrease() override { return cnt_.fetch_sub(1) == 1 ? false : true; }
+  bool TryIncrease() {
+    size_t cnt = cnt_.load(std::memory_order_relaxed);
+    while (cnt != 0) {
+      if (cnt_.compare_exchange_weak(cnt, cnt + 1, std::memory_order_acq_rel,
+                                     std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
 
-  ~ThreadSafeRefCount() override = default;
+  bool TryDecrease() {
+    if (cnt_.fetch_sub(1, std::memory_order_release) != 1) {
+      return true;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+  }
 };
 
 template <typename R>
-concept AsRefCount =
-    std::default_initializable<R> && std::derived_from<R, RefCount>;
+concept AsRefCount = std::default_initializable<R> && requires(R cnt) {
+  { cnt.Get() } -> std::same_as<size_t>;
+  { cnt.Increase() } -> std::same_as<void>;
+  { cnt.TryIncrease() } -> std::same_as<bool>;
+  { cnt.TryDecrease() } -> std::same_as<bool>;
+};
+
+// Control block shared by every Shared and Unretained of one object. All
+// Shared together hold a single unretained reference, so the block is released
+// by whichever handle drops the last reference of either kind.
+template <AsRefCount R>
+struct SharedBlock {
+  R ref_cnt_;
+  R unretained_ref_cnt_;
+
+  SharedBlock() {
+    ref_cnt_.Increase();
+    unretained_ref_cnt_.Increase();
+  }
+
+  virtual ~SharedBlock() = default;
+
+  virtual void DestroyValue() = 0;
+  virtual void Release() = 0;
+
+  void DropRetained() {
+    if (!ref_cnt_.TryDecrease()) {
+      DestroyValue();
+      DropUnretained();
+    }
+  }
+
+  void DropUnretained() {
+    if (!unretained_ref_cnt_.TryDecrease()) {
+      Release();
+    }
+  }
+};
+
+// Object allocated in the same block as its counters, see Shared::New.
+template <typename T, AsRefCount R, AsAllocator A>
+struct SharedValueBlock : public SharedBlock<R> {
+  [[no_unique_address]] A allocator_;
+  alignas(T) std::byte storage_[sizeof(T)];
+
+  explicit SharedValueBlock(A allocator) : allocator_(allocator) {}
+
+  T* Value() { return std::launder(reinterpret_cast<T*>(storage_)); }
+
+  void DestroyValue() override { Value()->~T(); }
+
+  void Release() override {
+    A allocator = allocator_;
+    DeleteObject(allocator, this);
+  }
+};
+
+// Object allocated elsewhere and handed over with its own destructor.
+template <typename T, AsRefCount R, typename D, AsAllocator A>
+struct SharedPtrBlock : public SharedBlock<R> {
+  T* raw_ptr_;
+  [[no_unique_address]] D destructor_;
+  [[no_unique_address]] A allocator_;
+
+  SharedPtrBlock(T* raw_ptr, D destructor, A allocator)
+      : raw_ptr_(raw_ptr),
+        destructor_(std::move(destructor)),
+        allocator_(allocator) {}
+
+  void DestroyValue() override { destructor_(raw_ptr_); }
+
+  void Release() override {
+    A allocator = allocator_;
+    DeleteObject(allocator, this);
+  }
+};
+
+template <typename T, AsRefCount R>
+class Shared;
 
 template <typename T, AsRefCount R>
 class Unretained;
 
+// Frees the memory of a destroyed object created by `new T`, with the
+// deallocation function `delete` would have picked.
+template <typename T>
+void DeleteMemory(void* memory) {
+  if constexpr (requires(void* ptr) { T::operator delete(ptr); }) {
+    T::operator delete(memory);
+  } else if constexpr (requires(void* ptr) {
+                         T::operator delete(ptr, sizeof(T));
+                       }) {
+    T::operator delete(memory, sizeof(T));
+  } else {
+    ::operator delete(memory);
+  }
+}
+
+// Frees the memory of a destroyed object created by NewObject<T> from
+// HeapAllocator.
+template <typename T>
+void DeallocateHeapMemory(void* memory) {
+  HeapAllocator().Deallocate(memory, sizeof(T), alignof(T));
+}
+
+// Counters embedded in a RefCounted object. The last unretained reference
+// frees the object's memory, with whatever allocated it.
+template <AsRefCount R>
+struct RefCountedBlock {
+  R ref_cnt_;
+  R unretained_ref_cnt_;
+  void* memory_{nullptr};
+  void (*delete_memory_)(void* memory){nullptr};
+
+  void DropUnretained() {
+    if (!unretained_ref_cnt_.TryDecrease()) {
+      void* memory = memory_;
+      auto delete_memory = delete_memory_;
+      this->~RefCountedBlock();
+      delete_memory(memory);
+    }
+  }
+};
+
+// Inherit from this to keep the counters inside the object. Shared and
+// Unretained of such types are a single pointer, and Shared::Share(this) hands
+// out another reference from inside the object once it is owned by a Shared.
+template <AsRefCount R>
+class RefCounted {
+ public:
+  RefCounted(const RefCounted& other) = delete;
+  RefCounted& operator=(const RefCounted& other) = delete;
+
+ protected:
+  RefCounted() { new (storage_) Block(); }
+
+  ~RefCounted() = default;
+
+ private:
+  template <typename T, AsRefCount>
+  friend class Shared;
+
+  template <typename T, AsRefCount>
+  friend class Unretained;
+
+  using Block = RefCountedBlock<R>;
+
+  static Block* BlockOf(RefCounted* ref_counted) {
+    return std::launder(reinterpret_cast<Block*>(ref_counted->storage_));
+  }
+
+  // The counters are created in raw storage rather than as members, so they
+  // outlive the object until the last Unretained frees the memory.
+  alignas(Block) std::byte storage_[sizeof(Block)];
+};
+
 template <typename T, AsRefCount R>
 class Shared {
  public:
-  using Destructor = std::function<void(T*)>;
+  static constexpr bool kIntrusive = std::derived_from<T, RefCounted<R>>;
+
+  using Block =
+      std::conditional_t<kIntrusive, RefCountedBlock<R>, SharedBlock<R>>;
+
+  // A RefCounted T with its own operator delete may be the base of what was
+  // allocated, whose size that delete needs, so it must come from New.
+  static constexpr bool kAdoptable =
+      !kIntrusive || std::is_final_v<T> || !std::is_polymorphic_v<T> ||
+      !(requires(void* ptr) { T::operator delete(ptr); } ||
+        requires(void* ptr) { T::operator delete(ptr, sizeof(T)); });
 
   Shared() = default;
   Shared(const Shared& other) = delete;
 
   Shared Clone() const {
-    auto cloned = Shared(raw_ptr_, ref_cnt_, unretained_ref_cnt_, destructor_);
-    if (ref_cnt_) {
-      ref_cnt_->Increase();
+    Block* block = GetBlock();
+    if (block) {
+      block->ref_cnt_.Increase();
     }
-    return cloned;
+    return Shared(raw_ptr_, block);
   }
 
   Shared(Shared&& other) noexcept
-      : raw_ptr_(other.raw_ptr_),
-        ref_cnt_(other.ref_cnt_),
-        unretained_ref_cnt_(other.unretained_ref_cnt_),
-        destructor_(other.destructor_) {
+      : raw_ptr_(other.raw_ptr_), block_(other.block_) {
     other.raw_ptr_ = nullptr;
-    other.ref_cnt_ = nullptr;
-    other.unretained_ref_cnt_ = nullptr;
-    other.destructor_ = DefaultDestructor;
+    other.block_ = {};
   }
 
-  Shared(T* raw_ptr, Destructor destructor = DefaultDestructor)
-      : raw_ptr_(raw_ptr),
-        ref_cnt_(new R()),
-        unretained_ref_cnt_(new R()),
-        destructor_(destructor) {
-    ref_cnt_->Increase();
+  // Adopts an object from `new T`, or for RefCounted types also takes another
+  // reference to one already owned.
+  Shared(T* raw_ptr)
+    requires kAdoptable
+      : raw_ptr_(raw_ptr) {
+    if constexpr (kIntrusive) {
+      if (raw_ptr_ != nullptr) {
+        Retain(nullptr);
+      }
+    } else {
+      block_ = NewPtrBlock([](T* raw_ptr) { delete raw_ptr; }, HeapAllocator());
+    }
+  }
+
+  template <std::invocable<T*> D>
+  Shared(T* raw_ptr, D destructor)
+      : Shared(raw_ptr, std::move(destructor), HeapAllocator()) {}
+
+  template <std::invocable<T*> D, AsAllocator A>
+  Shared(T* raw_ptr, D destructor, A allocator) : raw_ptr_(raw_ptr) {
+    static_assert(!kIntrusive, "RefCounted objects are destroyed in place.");
+    block_ = NewPtrBlock(std::move(destructor), allocator);
   }
 
   template <typename... Args>
   static Shared New(Args&&... args) {
-    return Shared(new T(args...));
+    if constexpr (kIntrusive) {
+      // Types with their own operator new keep it, the rest go to the heap
+      // allocator like every other Shared.
+      Shared shared;
+      if constexpr (requires { T::operator new(sizeof(T)); }) {
+        shared.raw_ptr_ = new T(std::forward<Args>(args)...);
+        shared.Retain(&DeleteMemory<T>);
+      } else {
+        HeapAllocator allocator;
+        shared.raw_ptr_ = NewObject<T>(allocator, std::forward<Args>(args)...);
+        shared.Retain(&DeallocateHeapMemory<T>);
+      }
+      return shared;
+    } else {
+      return NewIn(HeapAllocator(), std::forward<Args>(args)...);
+    }
+  }
+
+  // Another reference to a RefCounted object already owned by a Shared, as
+  // from inside the object. Never adopts, so it works for every RefCounted.
+  static Shared Share(T* raw_ptr)
+    requires kIntrusive
+  {
+    if (raw_ptr == nullptr) {
+      return Shared();
+    }
+    if (!GetBlock(raw_ptr, {})->ref_cnt_.TryIncrease()) {
+      throw std::invalid_argument(
+          "This object is supposed to be owned by a Shared.");
+    }
+    return Shared(raw_ptr, nullptr);
+  }
+
+  template <AsAllocator A, typename... Args>
+  static Shared NewIn(A allocator, Args&&... args) {
+    static_assert(!kIntrusive, "RefCounted objects are allocated by New.");
+    auto* block = NewObject<SharedValueBlock<T, R, A>>(allocator, allocator);
+    try {
+      new (block->storage_) T(std::forward<Args>(args)...);
+    } catch (...) {
+      DeleteObject(allocator, block);
+      throw;
+    }
+    return Shared(block->Value(), block);
   }
 
   Shared& operator=(const Shared& other) {
@@ -117,11 +352,17 @@ class Shared {
   }
 
   ~Shared() {
-    if (ref_cnt_ != nullptr && !ref_cnt_->TryDecrease()) {
-      destructor_(raw_ptr_);
-      if (unretained_ref_cnt_ == nullptr) {
-        delete ref_cnt_;
+    Block* block = GetBlock();
+    if (block == nullptr) {
+      return;
+    }
+    if constexpr (kIntrusive) {
+      if (!block->ref_cnt_.TryDecrease()) {
+        raw_ptr_->~T();
+        block->DropUnretained();
       }
+    } else {
+      block->DropRetained();
     }
   }
 
@@ -133,26 +374,73 @@ class Shared {
 
   bool IsNull() const { return raw_ptr_ == nullptr; }
 
-  size_t RefCnt() const { return ref_cnt_->Get(); }
+  size_t RefCnt() const { return GetBlock()->ref_cnt_.Get(); }
 
-  size_t UnretainedRefCnt() const { return unretained_ref_cnt_->Get(); }
+  size_t UnretainedRefCnt() const {
+    return GetBlock()->unretained_ref_cnt_.Get() - 1;
+  }
 
  private:
   friend class Unretained<T, R>;
 
-  Shared(T* raw_ptr, RefCount* ref_cnt, RefCount* unretained_ref_cnt,
-         Destructor destructor)
-      : raw_ptr_(raw_ptr),
-        ref_cnt_(ref_cnt),
-        unretained_ref_cnt_(unretained_ref_cnt),
-        destructor_(destructor) {}
+  struct NoBlock {};
+
+  using BlockField = std::conditional_t<kIntrusive, NoBlock, Block*>;
+
+  Shared(T* raw_ptr, Block* block) : raw_ptr_(raw_ptr) {
+    if constexpr (!kIntrusive) {
+      block_ = block;
+    }
+  }
 
-  static void DefaultDestructor(T* raw_ptr) { delete raw_ptr; }
+  static Block* GetBlock(T* raw_ptr, BlockField block) {
+    if constexpr (kIntrusive) {
+      static_assert(requires(RefCounted<R>* base) { static_cast<T*>(base); },
+                    "RefCounted is supposed to be a non-virtual base.");
+      return raw_ptr == nullptr ? nullptr : RefCounted<R>::BlockOf(raw_ptr);
+    } else {
+      return block;
+    }
+  }
+
+  Block* GetBlock() const { return GetBlock(raw_ptr_, block_); }
+
+  template <typename D, AsAllocator A>
+  Block* NewPtrBlock(D destructor, A allocator) {
+    using PtrBlock = SharedPtrBlock<T, R, D, A>;
+    try {
+      return NewObject<PtrBlock>(allocator, raw_ptr_, destructor, allocator);
+    } catch (...) {
+      destructor(raw_ptr_);
+      throw;
+    }
+  }
+
+  // Take a reference to a RefCounted object, becoming its first owner if it
+  // has none yet. `delete_memory` frees it in the end, null when adopting an
+  // object from `new T`.
+  void Retain(void (*delete_memory)(void* memory)) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "Over-aligned RefCounted objects are not supported.");
+    Block* block = GetBlock();
+    if (block->ref_cnt_.TryIncrease()) {
+      return;
+    }
+    if (delete_memory == nullptr) {
+      delete_memory = &DeleteMemory<T>;
+    }
+    block->delete_memory_ = delete_memory;
+    if constexpr (std::is_polymorphic_v<T>) {
+      block->memory_ = dynamic_cast<void*>(raw_ptr_);
+    } else {
+      block->memory_ = raw_ptr_;
+    }
+    block->ref_cnt_.Increase();
+    block->unretained_ref_cnt_.Increase();
+  }
 
   T* raw_ptr_{nullptr};
-  RefCount* ref_cnt_{nullptr};
-  RefCount* unretained_ref_cnt_{nullptr};
-  Destructor destructor_{DefaultDestructor};
+  [[no_unique_address]] BlockField block_{};
 };
 
 template <typename T>
@@ -4,14 +4,12 @@
 #include "pigeon_framework/base/auto_ptr/shared.hpp"
 #include "pigeon_framework/define.hpp"
 
-#define INSTANTIATE_UNRETAINED_ASYNC(ValueType)              \
-  template class PIGEON_API std::function<void(ValueType*)>; \
-  template class PIGEON_API                                  \
+#define INSTANTIATE_UNRETAINED_ASYNC(ValueType) \
+  template class PIGEON_API                     \
       pigeon::Unretained<ValueType, pigeon::ThreadSafeRefCount>;
 
-#define INSTANTIATE_UNRETAINED_LOCAL(ValueType)              \
-  template class PIGEON_API std::function<void(ValueType*)>; \
-  template class PIGEON_API                                  \
+#define INSTANTIATE_UNRETAINED_LOCAL(ValueType) \
+  template class PIGEON_API                     \
       pigeon::Unretained<ValueType, pigeon::ThreadLocalRefCount>;
 
 namespace pigeon {
@@ -19,19 +17,18 @@ namespace pigeon {
 template <typename T, AsRefCount R>
 class Unretained {
  public:
-  using Destructor = typename Shared<T, R>::Destructor;
+  using Block = typename Shared<T, R>::Block;
+  using BlockField = typename Shared<T, R>::BlockField;
 
   Unretained() = default;
 
-  explicit Unretained(const Shared<T, R>& ptr)
-      : raw_ptr_(ptr.raw_ptr_),
-        ref_cnt_(ptr.ref_cnt_),
-        destructor_(ptr.destructor_) {
+  explicit Unretained(const Shared<T, R>& ptr) {
     if (ptr.IsNull()) {
       return;
     }
-    unretained_ref_cnt_ = ptr.unretained_ref_cnt_;
-    unretained_ref_cnt_->Increase();
+    raw_ptr_ = ptr.raw_ptr_;
+    block_ = ptr.block_;
+    GetBlock()->unretained_ref_cnt_.Increase();
   }
 
   Unretained(const Unretained& other) = delete;
@@ -39,29 +36,22 @@ class Unretained {
   Unretained Clone() const {
     Unretained cloned = Unretained();
     cloned.raw_ptr_ = raw_ptr_;
-    cloned.ref_cnt_ = ref_cnt_;
-    cloned.unretained_ref_cnt_ = unretained_ref_cnt_;
-    cloned.destructor_ = destructor_;
-    if (unretained_ref_cnt_) {
-      unretained_ref_cnt_->Increase();
+    cloned.block_ = block_;
+    if (Block* block = GetBlock()) {
+      block->unretained_ref_cnt_.Increase();
     }
     return cloned;
   }
 
   Unretained(Unretained&& other) noexcept
-      : raw_ptr_(other.raw_ptr_),
-        ref_cnt_(other.ref_cnt_),
-        unretained_ref_cnt_(other.unretained_ref_cnt_),
-        destructor_(other.destructor_) {
+      : raw_ptr_(other.raw_ptr_), block_(other.block_) {
     other.raw_ptr_ = nullptr;
-    other.ref_cnt_ = nullptr;
-    other.unretained_ref_cnt_ = nullptr;
+    other.block_ = {};
   }
 
   ~Unretained() {
-    if (unretained_ref_cnt_ != nullptr && !unretained_ref_cnt_->TryDecrease()) {
-      delete ref_cnt_;
-      delete unretained_ref_cnt_;
+    if (Block* block = GetBlock()) {
+      block->DropUnretained();
     }
   }
 
@@ -82,9 +72,9 @@ class Unretained {
   }
 
   Shared<T, R> TryUpgrade() const {
-    if (!IsNull()) {
-      ref_cnt_->Increase();
-      return Shared<T, R>(raw_ptr_, ref_cnt_, unretained_ref_cnt_, destructor_);
+    Block* block = GetBlock();
+    if (block != nullptr && block->ref_cnt_.TryIncrease()) {
+      return Shared<T, R>(raw_ptr_, block);
     } else {
       return Shared<T, R>();
     }
@@ -92,13 +82,16 @@ class Unretained {
 
   T* Get() const { return raw_ptr_; }
 
-  bool IsNull() const { return ref_cnt_ == nullptr || ref_cnt_->Get() == 0; }
+  bool IsNull() const {
+    Block* block = GetBlock();
+    return block == nullptr || block->ref_cnt_.Get() == 0;
+  }
 
  private:
+  Block* GetBlock() const { return Shared<T, R>::GetBlock(raw_ptr_, block_); }
+
   T* raw_ptr_{nullptr};
-  RefCount* ref_cnt_{nullptr};
-  RefCount* unretained_ref_cnt_{nullptr};
-  Destructor destructor_;
+  [[no_unique_address]] BlockField block_{};
 };
 
 template <typename T>
@@ -3,9 +3,18 @@
 
 #include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include "pigeon_framework/base/container/bitwise_search.hpp"
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "pigeon_framework/base/memory/relocate.hpp"
 
 namespace pigeon {
 
@@ -107,9 +116,25 @@ ArrayIterator<T> operator+(typename ArrayIterator<T>::difference_type diff,
 }
 
 template <typename T>
-concept ArrayValue = std::default_initializable<T> && std::movable<T>;
+concept ArrayValue = std::movable<T>;
 
-template <ArrayValue T>
+template <typename T, size_t N>
+struct ArrayInlineStorage {
+  T* Get() { return reinterpret_cast<T*>(bytes_); }
+
+  const T* Get() const { return reinterpret_cast<const T*>(bytes_); }
+
+  alignas(T) std::byte bytes_[N * sizeof(T)];
+};
+
+template <typename T>
+struct ArrayInlineStorage<T, 0> {
+  T* Get() const { return nullptr; }
+};
+
+// Up to `N` elements are stored inside the array itself, so small arrays don't
+// touch the heap. The inline buffer is reused whenever the size drops back.
+template <ArrayValue T, AsAllocator A = HeapAllocator, size_t N = 0>
 class Array {
  public:
   using Iterator = ArrayIterator<T>;
@@ -117,23 +142,23 @@ class Array {
 
   Array() = default;
 
-  Array(std::initializer_list<T> list) {
+  explicit Array(A allocator) : allocator_(std::move(allocator)) {}
+
+  Array(std::initializer_list<T> list, A allocator = A())
+      : allocator_(std::move(allocator)) {
     Reserve(list.size());
     for (const T& item : list) {
-      PushBack(std::move(item));
+      PushBack(item);
     }
   }
 
-  Array(const Array& other) {
+  Array(const Array& other) : allocator_(other.allocator_) {
     if constexpr (!std::copyable<T>) {
       throw std::invalid_argument("This type is supposed to be copyable.");
     } else {
+      Reserve(other.capacity_);
+      std::uninitialized_copy_n(other.data_, other.size_, data_);
       size_ = other.size_;
-      capacity_ = other.capacity_;
-      data_ = new T[capacity_]();
-      for (size_t i = 0; i < size_; ++i) {
-        data_[i] = other.data_[i];
-      }
     }
   }
 
@@ -145,11 +170,19 @@ class Array {
     return *this;
   }
 
-  Array(Array&& other) noexcept
-      : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+  Array(Array&& other) noexcept : allocator_(other.allocator_) {
+    if (other.IsInline()) {
+      RelocateRange(other.data_, other.size_, data_);
+      size_ = other.size_;
+      other.size_ = 0;
+      return;
+    }
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.data_ = other.inline_.Get();
     other.size_ = 0;
-    other.capacity_ = 0;
-    other.data_ = nullptr;
+    other.capacity_ = N;
   }
 
   Array& operator=(Array&& other) noexcept {
@@ -164,14 +197,18 @@ class Array {
 
   T& operator[](size_t index) { return data_[index]; }
 
+  const T& operator[](size_t index) const { return data_[index]; }
+
   bool operator==(const Array& other) const {
     if (size_ != other.size_) {
       return false;
     }
-    if (data_ == other.data_) {
+    if (size_ == 0 || data_ == other.data_) {
       return true;
     }
-    if constexpr (!std::equality_comparable<T>) {
+    if constexpr (kBitwiseComparable<T>) {
+      return std::memcmp(data_, other.data_, size_ * sizeof(T)) == 0;
+    } else if constexpr (!std::equality_comparable<T>) {
       return false;
     } else {
       for (size_t i = 0; i < size_; ++i) {
@@ -187,26 +224,68 @@ class Array {
     if constexpr (!std::copyable<T>) {
       throw std::invalid_argument("This type is supposed to be copyable.");
     } else {
-      EnsureNotFull();
-      data_[size_] = val;
-      ++size_;
+      Construct(val);
     }
   }
 
-  void EmplaceBack(T&& val) {
-    EnsureNotFull();
-    data_[size_] = std::move(val);
-    ++size_;
+  void EmplaceBack(T&& val) { Construct(std::move(val)); }
+
+  template <typename... Args>
+  void EmplaceBack(Args&&... args) {
+    Construct(std::forward<Args>(args)...);
   }
 
   template <typename... Args>
-  void EmplaceBack(Args... args) {
-    EnsureNotFull();
-    (&data_[size_])->~T();  // Manual destroy before placement new.
-    new (&data_[size_]) T(args...);
-    ++size_;
+  void Emplace(size_t index, Args&&... args) {
+    if (index > size_) {
+      throw std::out_of_range("Insert out of range.");
+    }
+    if (index == size_) {
+      Construct(std::forward<Args>(args)...);
+      return;
+    }
+    T val(std::forward<Args>(args)...);  // Args may refer into the gap.
+    new (OpenGap(index, 1)) T(std::move(val));
   }
 
+  // The range must not come from this array. Move-only values can be moved
+  // in with std::move_iterator. If a copy throws, the array is left as it was.
+  template <std::input_iterator I, std::sentinel_for<I> S>
+    requires std::forward_iterator<I> || std::sized_sentinel_for<S, I>
+  void InsertRange(size_t index, I first, S last) {
+    if (index > size_) {
+      throw std::out_of_range("Insert out of range.");
+    }
+    auto count = static_cast<size_t>(std::ranges::distance(first, last));
+    T* gap = OpenGap(index, count);
+    size_t built = 0;
+    try {
+      for (; first != last; ++first, ++built) {
+        new (gap + built) T(*first);
+      }
+    } catch (...) {
+      DestroyRange(gap, built);
+      CloseGap(index, count);
+      throw;
+    }
+  }
+
+  void InsertRange(size_t index, std::span<const T> items) {
+    if constexpr (!std::copyable<T>) {
+      throw std::invalid_argument("This type is supposed to be copyable.");
+    } else {
+      InsertRange(index, items.begin(), items.end());
+    }
+  }
+
+  template <std::input_iterator I, std::sentinel_for<I> S>
+    requires std::forward_iterator<I> || std::sized_sentinel_for<S, I>
+  void Append(I first, S last) {
+    InsertRange(size_, first, last);
+  }
+
+  void Append(std::span<const T> items) { InsertRange(size_, items); }
+
   void Reserve(size_t capacity) {
     if (capacity <= capacity_) {
       return;
@@ -217,13 +296,17 @@ class Array {
   void Resize(size_t size) {
     if (size == size_) {
       return;
-    } else if (size > size_) {
-      Reserve(size);
-      size_ = size;
+    } else if (size < size_) {
+      Truncate(size);
       return;
     }
-    while (size_ > size) {
-      PopBack();
+    if constexpr (!std::default_initializable<T>) {
+      throw std::invalid_argument(
+          "This type is supposed to be default initializable.");
+    } else {
+      Reserve(size);
+      std::uninitialized_value_construct_n(data_ + size_, size - size_);
+      size_ = size;
     }
   }
 
@@ -235,12 +318,11 @@ class Array {
   }
 
   void Clear() {
-    if (data_ != nullptr) {
-      delete[] data_;
-      data_ = nullptr;
-    }
+    DestroyRange(data_, size_);
+    FreeData();
+    data_ = inline_.Get();
     size_ = 0;
-    capacity_ = 0;
+    capacity_ = N;
   }
 
   T PopBack() {
@@ -248,7 +330,9 @@ class Array {
       throw std::out_of_range("Try to pop from an empty array.");
     }
     --size_;
-    return std::move(data_[size_]);
+    T val(std::move(data_[size_]));
+    data_[size_].~T();
+    return val;
   }
 
   void Swap(size_t index_a, size_t index_b) {
@@ -268,24 +352,69 @@ class Array {
     }
   }
 
-  void Insert(size_t index, T&& val) {
-    if (index > size_) {
-      throw std::out_of_range("Insert out of range.");
-    }
-    EmplaceBack(std::move(val));
-    for (size_t i = size_ - 1; i > index; --i) {
-      Swap(i, i - 1);
-    }
-  }
+  void Insert(size_t index, T&& val) { Emplace(index, std::move(val)); }
 
   T Remove(size_t index) {
     if (index >= size_) {
       throw std::out_of_range("Remove out of range.");
     }
-    for (size_t i = index; i < size_ - 1; ++i) {
-      Swap(i, i + 1);
+    T val(std::move(data_[index]));
+    data_[index].~T();
+    CloseGap(index, 1);
+    return val;
+  }
+
+  void EraseRange(size_t index, size_t count) {
+    if (index > size_ || count > size_ - index) {
+      throw std::out_of_range("Remove out of range.");
     }
-    return PopBack();
+    DestroyRange(data_ + index, count);
+    CloseGap(index, count);
+  }
+
+  // Remove every element matching `pred` and keep the order of the others.
+  // Return the number of removed elements.
+  template <std::predicate<T&> P>
+  size_t EraseIf(P pred) {
+    size_t tail = 0;
+    for (size_t i = 0; i < size_; ++i) {
+      if (pred(data_[i])) {
+        continue;
+      }
+      if (i != tail) {
+        data_[tail] = std::move(data_[i]);
+      }
+      ++tail;
+    }
+    return Truncate(tail);
+  }
+
+  template <std::predicate<T&> P>
+  size_t RetainIf(P pred) {
+    return EraseIf([&pred](T& val) { return !pred(val); });
+  }
+
+  // Like EraseIf, but fill each hole with the last element instead of
+  // shifting, so the order is not kept.
+  template <std::predicate<T&> P>
+  size_t SwapEraseIf(P pred) {
+    size_t size = size_;
+    for (size_t i = 0; i < size;) {
+      if (!pred(data_[i])) {
+        ++i;
+        continue;
+      }
+      --size;
+      if (i != size) {
+        data_[i] = std::move(data_[size]);
+      }
+    }
+    return Truncate(size);
+  }
+
+  template <std::predicate<T&> P>
+  size_t SwapRetainIf(P pred) {
+    return SwapEraseIf([&pred](T& val) { return !pred(val); });
   }
 
   T SwapRemove(size_t index) {
@@ -296,6 +425,44 @@ class Array {
     return PopBack();
   }
 
+  std::optional<size_t> IndexOf(const T& val) const
+    requires std::equality_comparable<T>
+  {
+    size_t index = FindIndex(val);
+    if (index == size_) {
+      return std::nullopt;
+    }
+    return index;
+  }
+
+  Iterator Find(const T& val)
+    requires std::equality_comparable<T>
+  {
+    return Iterator(data_ + FindIndex(val));
+  }
+
+  ConstIterator Find(const T& val) const
+    requires std::equality_comparable<T>
+  {
+    return ConstIterator(data_ + FindIndex(val));
+  }
+
+  bool Contains(const T& val) const
+    requires std::equality_comparable<T>
+  {
+    return FindIndex(val) != size_;
+  }
+
+  size_t Count(const T& val) const
+    requires std::equality_comparable<T>
+  {
+    if constexpr (kBitwiseSearchable<T>) {
+      return BitwiseCount(data_, size_, val);
+    } else {
+      return static_cast<size_t>(std::count(data_, data_ + size_, val));
+    }
+  }
+
   bool IsEmpty() const { return size_ == 0; }
 
   T* Get() const { return data_; }
@@ -304,18 +471,23 @@ class Array {
 
   size_t Capacity() const { return capacity_; }
 
-  void SetCapacity(size_t capacity) {
-    size_t size = std::min(capacity, size_);
+  const A& GetAllocator() const { return allocator_; }
 
-    T* new_data = new T[capacity]();
-    for (size_t i = 0; i < size; ++i) {
-      new_data[i] = std::move(data_[i]);
+  void SetCapacity(size_t capacity) {
+    if (capacity < size_) {
+      DestroyRange(data_ + capacity, size_ - capacity);
+      size_ = capacity;
     }
-    if (data_ != nullptr) {
-      delete[] data_;
+    if (capacity <= N) {
+      if (IsInline()) {
+        return;
+      }
+      capacity = N;
     }
+    T* new_data = capacity == N ? inline_.Get() : Allocate(capacity);
+    RelocateRange(data_, size_, new_data);
+    FreeData();
     data_ = new_data;
-    size_ = size;
     capacity_ = capacity;
   }
 
@@ -328,20 +500,102 @@ class Array {
   ConstIterator end() const { return ConstIterator(data_ + size_); }
 
  private:
-  void EnsureNotFull() {
-    if (capacity_ == 0) {
-      capacity_ = 1;
-      data_ = new T[1]();
-    } else if (size_ == capacity_) {
-      Reserve(2 * capacity_);
+  T* Allocate(size_t capacity) {
+    if (capacity == 0) {
+      return nullptr;
     }
+    return static_cast<T*>(
+        allocator_.Allocate(capacity * sizeof(T), alignof(T)));
   }
 
-  T* data_{nullptr};
+  bool IsInline() const { return N != 0 && data_ == inline_.Get(); }
+
+  void FreeData() {
+    if (data_ != nullptr && !IsInline()) {
+      allocator_.Deallocate(data_, capacity_ * sizeof(T), alignof(T));
+    }
+  }
+
+  size_t FindIndex(const T& val) const
+    requires std::equality_comparable<T>
+  {
+    if constexpr (kBitwiseSearchable<T>) {
+      return BitwiseFind(data_, size_, val);
+    } else {
+      return static_cast<size_t>(std::find(data_, data_ + size_, val) - data_);
+    }
+  }
+
+  size_t NextCapacity(size_t count = 1) const {
+    return std::max(capacity_ == 0 ? 1 : 2 * capacity_, size_ + count);
+  }
+
+  // Make `count` uninitialized slots at `index`, shifting the tail up. When
+  // growing, both halves go straight to their final place in the new buffer.
+  T* OpenGap(size_t index, size_t count) {
+    if (size_ + count <= capacity_) {
+      RelocateOverlapping(data_ + index, size_ - index, data_ + index + count);
+    } else {
+      size_t capacity = NextCapacity(count);
+      T* new_data = Allocate(capacity);
+      RelocateRange(data_, index, new_data);
+      RelocateRange(data_ + index, size_ - index, new_data + index + count);
+      FreeData();
+      data_ = new_data;
+      capacity_ = capacity;
+    }
+    size_ += count;
+    return data_ + index;
+  }
+
+  // Shift the tail down over `count` already destroyed slots at `index`.
+  void CloseGap(size_t index, size_t count) {
+    size_t tail = index + count;
+    RelocateOverlapping(data_ + tail, size_ - tail, data_ + index);
+    size_ -= count;
+  }
+
+  size_t Truncate(size_t size) {
+    size_t erased = size_ - size;
+    DestroyRange(data_ + size, erased);
+    size_ = size;
+    return erased;
+  }
+
+  // Construct the new element before relocating, so that arguments referring
+  // into this array stay valid while it grows.
+  template <typename... Args>
+  void Construct(Args&&... args) {
+    if (size_ < capacity_) {
+      new (data_ + size_) T(std::forward<Args>(args)...);
+      ++size_;
+      return;
+    }
+    size_t capacity = NextCapacity();
+    T* new_data = Allocate(capacity);
+    try {
+      new (new_data + size_) T(std::forward<Args>(args)...);
+    } catch (...) {
+      allocator_.Deallocate(new_data, capacity * sizeof(T), alignof(T));
+      throw;
+    }
+    RelocateRange(data_, size_, new_data);
+    FreeData();
+    data_ = new_data;
+    capacity_ = capacity;
+    ++size_;
+  }
+
+  [[no_unique_address]] A allocator_;
+  [[no_unique_address]] ArrayInlineStorage<T, N> inline_;
+  T* data_{inline_.Get()};
   size_t size_{0};
-  size_t capacity_{0};
+  size_t capacity_{N};
 };
 
+template <ArrayValue T, size_t N, AsAllocator A = HeapAllocator>
+using InlineArray = Array<T, A, N>;
+
 }  // namespace pigeon
 
 #endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_ARRAY
@@ -0,0 +1,241 @@
+#ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_BITWISE_SEARCH
+#define PIGEON_FRAMEWORK_BASE_CONTAINER_BITWISE_SEARCH
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define PIGEON_SIMD_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIGEON_SIMD_SSE2
+#endif
+
+#if defined(PIGEON_SIMD_AVX2) || defined(PIGEON_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace pigeon {
+
+// Types whose values are equal exactly when their bytes are equal. Floating
+// point is excluded because of NaN and signed zero. Specialize this for plain
+// structs without padding to get the fast paths.
+template <typename T>
+struct IsBitwiseComparable
+    : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T> ||
+                         std::is_pointer_v<T>> {};
+
+template <typename T>
+inline constexpr bool kBitwiseComparable = IsBitwiseComparable<T>::value;
+
+template <typename T>
+inline constexpr bool kBitwiseSearchable =
+    kBitwiseComparable<T> && (sizeof(T) == 1 || sizeof(T) == 2 ||
+                              sizeof(T) == 4 || sizeof(T) == 8);
+
+namespace bitwise_search {
+
+template <size_t W>
+using Unsigned = std::conditional_t<
+    W == 1, uint8_t,
+    std::conditional_t<W == 2, uint16_t,
+                       std::conditional_t<W == 4, uint32_t, uint64_t>>>;
+
+#if defined(PIGEON_SIMD_AVX2)
+struct Avx2 {
+  using Vec = __m256i;
+  static constexpr size_t kBytes = 32;
+
+  static Vec Load(const std::byte* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+  }
+
+  template <typename U>
+  static Vec Splat(U val) {
+    if constexpr (sizeof(U) == 1) {
+      return _mm256_set1_epi8(static_cast<char>(val));
+    } else if constexpr (sizeof(U) == 2) {
+      return _mm256_set1_epi16(static_cast<int16_t>(val));
+    } else if constexpr (sizeof(U) == 4) {
+      return _mm256_set1_epi32(static_cast<int32_t>(val));
+    } else {
+      return _mm256_set1_epi64x(static_cast<int64_t>(val));
+    }
+  }
+
+  // One bit per byte, set for every byte of every equal lane.
+  template <size_t W>
+  static uint32_t EqualMask(Vec lhs, Vec rhs) {
+    Vec equal;
+    if constexpr (W == 1) {
+      equal = _mm256_cmpeq_epi8(lhs, rhs);
+    } else if constexpr (W == 2) {
+      equal = _mm256_cmpeq_epi16(lhs, rhs);
+    } else if constexpr (W == 4) {
+      equal = _mm256_cmpeq_epi32(lhs, rhs);
+    } else {
+      equal = _mm256_cmpeq_epi64(lhs, rhs);
+    }
+    return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+  }
+};
+#endif
+
+#if defined(PIGEON_SIMD_SSE2)
+struct Sse2 {
+  using Vec = __m128i;
+  static constexpr size_t kBytes = 16;
+
+  static Vec Load(const std::byte* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+  }
+
+  template <typename U>
+  static Vec Splat(U val) {
+    if constexpr (sizeof(U) == 1) {
+      return _mm_set1_epi8(static_cast<char>(val));
+    } else if constexpr (sizeof(U) == 2) {
+      return _mm_set1_epi16(static_cast<int16_t>(val));
+    } else if constexpr (sizeof(U) == 4) {
+      return _mm_set1_epi32(static_cast<int32_t>(val));
+    } else {
+      return _mm_set1_epi64x(static_cast<int64_t>(val));
+    }
+  }
+
+  template <size_t W>
+  static uint32_t EqualMask(Vec lhs, Vec rhs) {
+    Vec equal;
+    if constexpr (W == 1) {
+      equal = _mm_cmpeq_epi8(lhs, rhs);
+    } else if constexpr (W == 2) {
+      equal = _mm_cmpeq_epi16(lhs, rhs);
+    } else if constexpr (W == 4) {
+      equal = _mm_cmpeq_epi32(lhs, rhs);
+    } else {
+      // No 64-bit compare in SSE2, so both 32-bit halves must match.
+      equal = _mm_cmpeq_epi32(lhs, rhs);
+      equal = _mm_and_si128(equal,
+                            _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+    return static_cast<uint32_t>(_mm_movemask_epi8(equal));
+  }
+};
+#endif
+
+template <typename U>
+U LoadScalar(const std::byte* ptr) {
+  U val;
+  std::memcpy(&val, ptr, sizeof(U));
+  return val;
+}
+
+template <typename V, typename U>
+size_t Find(const std::byte* data, size_t size, U val) {
+  constexpr size_t kLanes = V::kBytes / sizeof(U);
+  auto needle = V::Splat(val);
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    uint32_t mask = V::template EqualMask<sizeof(U)>(
+        V::Load(data + i * sizeof(U)), needle);
+    if (mask != 0) {
+      return i + std::countr_zero(mask) / sizeof(U);
+    }
+  }
+  for (; i < size; ++i) {
+    if (LoadScalar<U>(data + i * sizeof(U)) == val) {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename V, typename U>
+size_t Count(const std::byte* data, size_t size, U val) {
+  constexpr size_t kLanes = V::kBytes / sizeof(U);
+  auto needle = V::Splat(val);
+  size_t cnt = 0;
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    uint32_t mask = V::template EqualMask<sizeof(U)>(
+        V::Load(data + i * sizeof(U)), needle);
+    cnt += std::popcount(mask);
+  }
+  cnt /= sizeof(U);
+  for (; i < size; ++i) {
+    if (LoadScalar<U>(data + i * sizeof(U)) == val) {
+      ++cnt;
+    }
+  }
+  return cnt;
+}
+
+template <typename U>
+size_t ScalarFind(const std::byte* data, size_t size, U val) {
+  if constexpr (sizeof(U) == 1) {
+    auto* found = static_cast<const std::byte*>(
+        std::memchr(data, static_cast<int>(val), size));
+    return found == nullptr ? size : static_cast<size_t>(found - data);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (LoadScalar<U>(data + i * sizeof(U)) == val) {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename U>
+size_t ScalarCount(const std::byte* data, size_t size, U val) {
+  size_t cnt = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (LoadScalar<U>(data + i * sizeof(U)) == val) {
+      ++cnt;
+    }
+  }
+  return cnt;
+}
+
+}  // namespace bitwise_search
+
+// Index of the first element bitwise equal to `val`, or `size` if none is.
+template <typename T>
+  requires kBitwiseSearchable<T>
+size_t BitwiseFind(const T* data, size_t size, const T& val) {
+  using U = bitwise_search::Unsigned<sizeof(T)>;
+  auto* bytes = reinterpret_cast<const std::byte*>(data);
+  auto needle = bitwise_search::LoadScalar<U>(
+      reinterpret_cast<const std::byte*>(&val));
+#if defined(PIGEON_SIMD_AVX2)
+  return bitwise_search::Find<bitwise_search::Avx2>(bytes, size, needle);
+#elif defined(PIGEON_SIMD_SSE2)
+  return bitwise_search::Find<bitwise_search::Sse2>(bytes, size, needle);
+#else
+  return bitwise_search::ScalarFind(bytes, size, needle);
+#endif
+}
+
+template <typename T>
+  requires kBitwiseSearchable<T>
+size_t BitwiseCount(const T* data, size_t size, const T& val) {
+  using U = bitwise_search::Unsigned<sizeof(T)>;
+  auto* bytes = reinterpret_cast<const std::byte*>(data);
+  auto needle = bitwise_search::LoadScalar<U>(
+      reinterpret_cast<const std::byte*>(&val));
+#if defined(PIGEON_SIMD_AVX2)
+  return bitwise_search::Count<bitwise_search::Avx2>(bytes, size, needle);
+#elif defined(PIGEON_SIMD_SSE2)
+  return bitwise_search::Count<bitwise_search::Sse2>(bytes, size, needle);
+#else
+  return bitwise_search::ScalarCount(bytes, size, needle);
+#endif
+}
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_BITWISE_SEARCH
@@ -1,79 +1,652 @@
 #ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_DOUBLY_LINKED_LIST
 #define PIGEON_FRAMEWORK_BASE_CONTAINER_DOUBLY_LINKED_LIST
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <initializer_list>
 #include <iterator>
+#include <new>
 #include <stdexcept>
-#include "pigeon_framework/base/auto_ptr/shared.hpp"
-#include "pigeon_framework/base/auto_ptr/unretained.hpp"
+#include <type_traits>
+#include <utility>
+#include "pigeon_framework/base/memory/allocator.hpp"
 
 namespace pigeon {
 
-template <typename T>
-concept ListValue = std::default_initializable<T> && std::movable<T>;
+struct ListLinks;
 
-template <ListValue T>
-struct DoublyLinkedListNode {
-  T item_;
-  DoublyLinkedListNode* prev_{nullptr};
-  DoublyLinkedListNode* next_{nullptr};
+// Links of an element in a circular list. Types kept in an IntrusiveList
+// derive from it, once per list they can be in at the same time, told apart
+// by Tag. Copies are not linked anywhere.
+template <typename Tag = void>
+class ListHook {
+ public:
+  ListHook() = default;
+  ListHook(const ListHook&) {}
+  ListHook& operator=(const ListHook&) { return *this; }
 
-  DoublyLinkedListNode() = default;
+  bool IsLinked() const { return next_ != nullptr; }
 
-  DoublyLinkedListNode(T&& item) : item_(std::move(item)) {}
+ private:
+  friend struct ListLinks;
 
-  DoublyLinkedListNode(const T& item) {
-    if constexpr (!std::copyable<T>) {
-      throw std::invalid_argument("This type is supposed to be copyable.");
-    } else {
-      item_ = item;
+  ListHook* prev_{nullptr};
+  ListHook* next_{nullptr};
+};
+
+// The O(1) relinking both lists are built on. A list is a sentinel hook whose
+// neighbours are the last and the first element.
+struct ListLinks {
+  template <typename H>
+  static H* Next(H* hook) {
+    return hook->next_;
+  }
+
+  template <typename H>
+  static H* Prev(H* hook) {
+    return hook->prev_;
+  }
+
+  template <typename H>
+  static void InitSentinel(H& sentinel) {
+    sentinel.prev_ = &sentinel;
+    sentinel.next_ = &sentinel;
+  }
+
+  template <typename H>
+  static void LinkBefore(H* pos, H* hook) {
+    hook->prev_ = pos->prev_;
+    hook->next_ = pos;
+    pos->prev_->next_ = hook;
+    pos->prev_ = hook;
+  }
+
+  template <typename H>
+  static void Unlink(H* hook) {
+    hook->prev_->next_ = hook->next_;
+    hook->next_->prev_ = hook->prev_;
+    hook->prev_ = nullptr;
+    hook->next_ = nullptr;
+  }
+
+  // Moves [first, last) in front of `pos`, which must not be inside the
+  // range. Nothing moves when the range already sits in front of `pos`, or
+  // starts with it.
+  template <typename H>
+  static void SpliceBefore(H* pos, H* first, H* last) {
+    if (first == last || pos == last || pos == first) {
+      return;
     }
+    H* back = last->prev_;
+    first->prev_->next_ = last;
+    last->prev_ = first->prev_;
+    first->prev_ = pos->prev_;
+    back->next_ = pos;
+    pos->prev_->next_ = first;
+    pos->prev_ = back;
   }
-};
 
-template <ListValue T>
-class DoublyLinkedList;
+  // Takes over the elements of `from`, whose sentinel lives elsewhere.
+  template <typename H>
+  static void MoveSentinel(H& from, H& to) {
+    if (from.next_ == &from) {
+      InitSentinel(to);
+      return;
+    }
+    to.next_ = from.next_;
+    to.prev_ = from.prev_;
+    to.next_->prev_ = &to;
+    to.prev_->next_ = &to;
+    InitSentinel(from);
+  }
+};
 
-template <typename T>
-class DoublyLinkedListConstIterator {
+// Bidirectional iterator over either list. Traits turn a hook into the value
+// it links. Iterators stay valid until their element is erased.
+template <typename Traits, bool kConst>
+class ListIterator {
  public:
+  using Hook = typename Traits::Hook;
   using iterator_concept = std::bidirectional_iterator_tag;
   using iterator_category = std::bidirectional_iterator_tag;
-  using iterator_type = DoublyLinkedListConstIterator;
-  using value_type = const T;
-  using difference_type = size_t;
-  using pointer = const T*;
-  using reference = const T&;
+  using iterator_type = ListIterator;
+  using value_type = typename Traits::Value;
+  using difference_type = ptrdiff_t;
+  using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+  using reference = std::conditional_t<kConst, const value_type&, value_type&>;
+
+  ListIterator() = default;
 
-  friend class DoublyLinkedList<T>;
+  explicit ListIterator(Hook* hook) : hook_(hook) {}
 
-  DoublyLinkedListConstIterator() = default;
+  // Iterator to ConstIterator.
+  template <bool kOtherConst>
+    requires(kConst && !kOtherConst)
+  ListIterator(const ListIterator<Traits, kOtherConst>& other)
+      : hook_(other.hook_) {}
 
- protected:
-  DoublyLinkedListNode<T>* here{nullptr};
+  reference operator*() const { return Traits::ValueOf(hook_); }
+
+  pointer operator->() const { return &Traits::ValueOf(hook_); }
+
+  iterator_type& operator++() {
+    hook_ = ListLinks::Next(hook_);
+    return *this;
+  }
+
+  iterator_type operator++(int) {
+    iterator_type temp(*this);
+    ++(*this);
+    return temp;
+  }
+
+  iterator_type& operator--() {
+    hook_ = ListLinks::Prev(hook_);
+    return *this;
+  }
+
+  iterator_type operator--(int) {
+    iterator_type temp(*this);
+    --(*this);
+    return temp;
+  }
+
+  bool operator==(const iterator_type& other) const {
+    return hook_ == other.hook_;
+  }
+
+  bool operator!=(const iterator_type& other) const {
+    return !(*this == other);
+  }
+
+  Hook* GetHook() const { return hook_; }
+
+ private:
+  template <typename U, bool kOtherConst>
+  friend class ListIterator;
+
+  Hook* hook_{nullptr};
 };
 
 template <typename T>
-class DoublyLinkedListIterator : public DoublyLinkedListConstIterator<T> {
- public:
-  using value_type = T;
-  using pointer = T*;
-  using reference = T&;
+concept ListValue = std::movable<T>;
+
+template <ListValue T>
+struct DoublyLinkedListNode : public ListHook<> {
+  alignas(T) std::byte storage_[sizeof(T)];
 
-  friend class DoublyLinkedList<T>;
+  T& Value() { return *std::launder(reinterpret_cast<T*>(storage_)); }
 };
 
 template <ListValue T>
+struct DoublyLinkedListTraits {
+  using Hook = ListHook<>;
+  using Value = T;
+
+  static T& ValueOf(Hook* hook) {
+    return static_cast<DoublyLinkedListNode<T>*>(hook)->Value();
+  }
+};
+
+template <ListValue T>
+using DoublyLinkedListIterator =
+    ListIterator<DoublyLinkedListTraits<T>, false>;
+
+template <ListValue T>
+using DoublyLinkedListConstIterator =
+    ListIterator<DoublyLinkedListTraits<T>, true>;
+
+// Owning list. Erased nodes are kept for reuse, so after Reserve or a warm-up
+// the list stops allocating. Splicing between lists is O(1) and needs equal
+// allocators, since a node is freed by the list it ends up in.
+template <ListValue T, AsAllocator A = HeapAllocator>
 class DoublyLinkedList {
  public:
   using Node = DoublyLinkedListNode<T>;
-  using ConstIterator = DoublyLinkedListConstIterator<T>;
+  using Hook = ListHook<>;
   using Iterator = DoublyLinkedListIterator<T>;
+  using ConstIterator = DoublyLinkedListConstIterator<T>;
+
+  DoublyLinkedList() : DoublyLinkedList(A()) {}
+
+  explicit DoublyLinkedList(A allocator) : allocator_(allocator) {
+    ListLinks::InitSentinel(sentinel_);
+    ListLinks::InitSentinel(free_);
+  }
+
+  DoublyLinkedList(std::initializer_list<T> items, A allocator = A())
+      : DoublyLinkedList(allocator) {
+    for (const T& item : items) {
+      PushBack(item);
+    }
+  }
+
+  DoublyLinkedList(const DoublyLinkedList& other)
+      : DoublyLinkedList(other.allocator_) {
+    if constexpr (!std::copyable<T>) {
+      throw std::invalid_argument("This type is supposed to be copyable.");
+    } else {
+      for (const T& item : other) {
+        PushBack(item);
+      }
+    }
+  }
+
+  DoublyLinkedList(DoublyLinkedList&& other) noexcept
+      : allocator_(other.allocator_),
+        size_(std::exchange(other.size_, 0)),
+        free_cnt_(std::exchange(other.free_cnt_, 0)) {
+    ListLinks::MoveSentinel(other.sentinel_, sentinel_);
+    ListLinks::MoveSentinel(other.free_, free_);
+  }
+
+  DoublyLinkedList& operator=(const DoublyLinkedList& other) {
+    if (this != &other) {
+      DoublyLinkedList copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  DoublyLinkedList& operator=(DoublyLinkedList&& other) noexcept {
+    if (this != &other) {
+      Clear();
+      ShrinkToFit();
+      allocator_ = other.allocator_;
+      size_ = std::exchange(other.size_, 0);
+      free_cnt_ = std::exchange(other.free_cnt_, 0);
+      ListLinks::MoveSentinel(other.sentinel_, sentinel_);
+      ListLinks::MoveSentinel(other.free_, free_);
+    }
+    return *this;
+  }
+
+  ~DoublyLinkedList() {
+    Clear();
+    ShrinkToFit();
+  }
+
+  bool operator==(const DoublyLinkedList& other) const
+    requires std::equality_comparable<T>
+  {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+
+  T& Front() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to access an empty list.");
+    }
+    return *begin();
+  }
+
+  T& Back() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to access an empty list.");
+    }
+    return *--end();
+  }
+
+  void PushBack(const T& item) { Insert(end(), item); }
+  void PushBack(T&& item) { Emplace(end(), std::move(item)); }
+  void PushFront(const T& item) { Insert(begin(), item); }
+  void PushFront(T&& item) { Emplace(begin(), std::move(item)); }
+
+  template <typename... Args>
+  T& EmplaceBack(Args&&... args) {
+    return *Emplace(end(), std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  T& EmplaceFront(Args&&... args) {
+    return *Emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  Iterator Insert(ConstIterator pos, const T& item) {
+    if constexpr (!std::copyable<T>) {
+      throw std::invalid_argument("This type is supposed to be copyable.");
+    } else {
+      return Emplace(pos, item);
+    }
+  }
+
+  Iterator Insert(ConstIterator pos, T&& item) {
+    return Emplace(pos, std::move(item));
+  }
+
+  template <typename... Args>
+  Iterator Emplace(ConstIterator pos, Args&&... args) {
+    Node* node = AcquireNode();
+    try {
+      new (node->storage_) T(std::forward<Args>(args)...);
+    } catch (...) {
+      ReleaseNode(node);
+      throw;
+    }
+    ListLinks::LinkBefore<Hook>(pos.GetHook(), node);
+    ++size_;
+    return Iterator(node);
+  }
+
+  // Returns the iterator following the erased element.
+  Iterator Erase(ConstIterator pos) {
+    Hook* hook = pos.GetHook();
+    if (hook == &sentinel_) {
+      throw std::out_of_range("Try to erase the end of a list.");
+    }
+    Iterator next(ListLinks::Next(hook));
+    ListLinks::Unlink(hook);
+    --size_;
+    Node* node = static_cast<Node*>(hook);
+    node->Value().~T();
+    ReleaseNode(node);
+    return next;
+  }
+
+  T PopFront() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to pop from an empty list.");
+    }
+    T item = std::move(*begin());
+    Erase(begin());
+    return item;
+  }
+
+  T PopBack() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to pop from an empty list.");
+    }
+    T item = std::move(*--end());
+    Erase(--end());
+    return item;
+  }
+
+  // Returns the number of erased elements.
+  template <std::predicate<T&> P>
+  size_t EraseIf(P pred) {
+    size_t size = size_;
+    for (Iterator it = begin(); it != end();) {
+      it = pred(*it) ? Erase(it) : std::next(it);
+    }
+    return size - size_;
+  }
+
+  // Moves all of `other` in front of `pos`.
+  void Splice(ConstIterator pos, DoublyLinkedList& other) {
+    if (&other == this || other.IsEmpty()) {
+      return;
+    }
+    CheckAllocator(other);
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), other.begin().GetHook(),
+                                  &other.sentinel_);
+    size_ += std::exchange(other.size_, 0);
+  }
+
+  // Moves the element at `it` of `other`, which may be this list, in front
+  // of `pos`.
+  void Splice(ConstIterator pos, DoublyLinkedList& other, ConstIterator it) {
+    CheckAllocator(other);
+    Hook* hook = it.GetHook();
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), hook, ListLinks::Next(hook));
+    --other.size_;
+    ++size_;
+  }
+
+  // Moves [first, last) of `other` in front of `pos`. Linear in the length
+  // of the range when `other` is another list, to keep both sizes right.
+  void Splice(ConstIterator pos, DoublyLinkedList& other, ConstIterator first,
+              ConstIterator last) {
+    CheckAllocator(other);
+    if (&other != this) {
+      size_t cnt = std::distance(first, last);
+      other.size_ -= cnt;
+      size_ += cnt;
+    }
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), first.GetHook(),
+                                  last.GetHook());
+  }
+
+  void MoveToFront(ConstIterator it) { Splice(begin(), *this, it); }
+  void MoveToBack(ConstIterator it) { Splice(end(), *this, it); }
+
+  // Keeps nodes for `capacity` elements, so inserting up to that many does
+  // not allocate.
+  void Reserve(size_t capacity) {
+    while (Capacity() < capacity) {
+      ReleaseNode(NewObject<Node>(allocator_));
+    }
+  }
+
+  // Frees the nodes kept for reuse.
+  void ShrinkToFit() {
+    while (free_cnt_ > 0) {
+      DeleteObject(allocator_, AcquireNode());
+    }
+  }
+
+  void Clear() {
+    while (!IsEmpty()) {
+      Erase(begin());
+    }
+  }
+
+  bool IsEmpty() const { return size_ == 0; }
+
+  size_t Size() const { return size_; }
+
+  size_t Capacity() const { return size_ + free_cnt_; }
+
+  A GetAllocator() const { return allocator_; }
+
+  Iterator begin() { return Iterator(ListLinks::Next(&sentinel_)); }
+  Iterator end() { return Iterator(&sentinel_); }
+
+  ConstIterator begin() const {
+    return ConstIterator(ListLinks::Next(Sentinel()));
+  }
+
+  ConstIterator end() const { return ConstIterator(Sentinel()); }
+
+ private:
+  Hook* Sentinel() const { return const_cast<Hook*>(&sentinel_); }
+
+  void CheckAllocator(const DoublyLinkedList& other) const {
+    if constexpr (std::equality_comparable<A>) {
+      if (!(allocator_ == other.allocator_)) {
+        throw std::invalid_argument(
+            "Spliced lists are supposed to share an allocator.");
+      }
+    }
+  }
+
+  // Free nodes wait in a second circular list, without a value.
+  Node* AcquireNode() {
+    if (free_cnt_ == 0) {
+      return NewObject<Node>(allocator_);
+    }
+    Hook* hook = ListLinks::Next(&free_);
+    ListLinks::Unlink(hook);
+    --free_cnt_;
+    return static_cast<Node*>(hook);
+  }
+
+  void ReleaseNode(Node* node) {
+    ListLinks::LinkBefore<Hook>(&free_, node);
+    ++free_cnt_;
+  }
+
+  [[no_unique_address]] A allocator_;
+  Hook sentinel_;
+  Hook free_;
+  size_t size_{0};
+  size_t free_cnt_{0};
+};
+
+template <typename T, typename Tag>
+struct IntrusiveListTraits {
+  using Hook = ListHook<Tag>;
+  using Value = T;
+
+  static T& ValueOf(Hook* hook) { return static_cast<T&>(*hook); }
+};
+
+// Non-owning list of elements that derive from ListHook<Tag>. Linking and
+// unlinking never allocates, and an element can be found in O(1) from
+// itself, which suits LRU orders and ready or parked queues. Elements must
+// outlive their membership; the list unlinks whatever is left when it dies.
+template <typename T, typename Tag = void>
+  requires std::derived_from<T, ListHook<Tag>>
+class IntrusiveList {
+ public:
+  using Hook = ListHook<Tag>;
+  using Iterator = ListIterator<IntrusiveListTraits<T, Tag>, false>;
+  using ConstIterator = ListIterator<IntrusiveListTraits<T, Tag>, true>;
+
+  IntrusiveList() { ListLinks::InitSentinel(sentinel_); }
+
+  IntrusiveList(const IntrusiveList& other) = delete;
+  IntrusiveList& operator=(const IntrusiveList& other) = delete;
+
+  IntrusiveList(IntrusiveList&& other) noexcept
+      : size_(std::exchange(other.size_, 0)) {
+    ListLinks::MoveSentinel(other.sentinel_, sentinel_);
+  }
+
+  IntrusiveList& operator=(IntrusiveList&& other) noexcept {
+    if (this != &other) {
+      Clear();
+      size_ = std::exchange(other.size_, 0);
+      ListLinks::MoveSentinel(other.sentinel_, sentinel_);
+    }
+    return *this;
+  }
+
+  ~IntrusiveList() { Clear(); }
+
+  T& Front() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to access an empty list.");
+    }
+    return *begin();
+  }
+
+  T& Back() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to access an empty list.");
+    }
+    return *--end();
+  }
+
+  void PushBack(T& item) { Insert(end(), item); }
+  void PushFront(T& item) { Insert(begin(), item); }
+
+  // `item` must not be in a list with the same tag.
+  Iterator Insert(ConstIterator pos, T& item) {
+    Hook* hook = &item;
+    if (hook->IsLinked()) {
+      throw std::invalid_argument("This item is already in a list.");
+    }
+    ListLinks::LinkBefore(pos.GetHook(), hook);
+    ++size_;
+    return Iterator(hook);
+  }
+
+  // Returns the iterator following the erased element.
+  Iterator Erase(ConstIterator pos) {
+    Hook* hook = pos.GetHook();
+    if (hook == &sentinel_) {
+      throw std::out_of_range("Try to erase the end of a list.");
+    }
+    Iterator next(ListLinks::Next(hook));
+    ListLinks::Unlink(hook);
+    --size_;
+    return next;
+  }
+
+  // `item` must be in this list.
+  void Remove(T& item) { Erase(IteratorTo(item)); }
+
+  T& PopFront() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to pop from an empty list.");
+    }
+    T& item = *begin();
+    Erase(begin());
+    return item;
+  }
+
+  T& PopBack() {
+    if (IsEmpty()) {
+      throw std::out_of_range("Try to pop from an empty list.");
+    }
+    T& item = *--end();
+    Erase(--end());
+    return item;
+  }
+
+  void Splice(ConstIterator pos, IntrusiveList& other) {
+    if (&other == this || other.IsEmpty()) {
+      return;
+    }
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), other.begin().GetHook(),
+                                  &other.sentinel_);
+    size_ += std::exchange(other.size_, 0);
+  }
+
+  void Splice(ConstIterator pos, IntrusiveList& other, ConstIterator it) {
+    Hook* hook = it.GetHook();
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), hook, ListLinks::Next(hook));
+    --other.size_;
+    ++size_;
+  }
+
+  // Linear in the length of the range when `other` is another list.
+  void Splice(ConstIterator pos, IntrusiveList& other, ConstIterator first,
+              ConstIterator last) {
+    if (&other != this) {
+      size_t cnt = std::distance(first, last);
+      other.size_ -= cnt;
+      size_ += cnt;
+    }
+    ListLinks::SpliceBefore<Hook>(pos.GetHook(), first.GetHook(),
+                                  last.GetHook());
+  }
+
+  void MoveToFront(T& item) { Splice(begin(), *this, IteratorTo(item)); }
+  void MoveToBack(T& item) { Splice(end(), *this, IteratorTo(item)); }
+
+  void Clear() {
+    while (!IsEmpty()) {
+      Erase(begin());
+    }
+  }
+
+  static Iterator IteratorTo(T& item) {
+    return Iterator(static_cast<Hook*>(&item));
+  }
+
+  static bool IsLinked(const T& item) {
+    return static_cast<const Hook&>(item).IsLinked();
+  }
+
+  bool IsEmpty() const { return size_ == 0; }
+
+  size_t Size() const { return size_; }
+
+  Iterator begin() { return Iterator(ListLinks::Next(&sentinel_)); }
+  Iterator end() { return Iterator(&sentinel_); }
+
+  ConstIterator begin() const {
+    return ConstIterator(ListLinks::Next(Sentinel()));
+  }
+
+  ConstIterator end() const { return ConstIterator(Sentinel()); }
 
  private:
-  Node* head_{nullptr};
-  Node* tail_{nullptr};
-  size_t size{0};
+  Hook* Sentinel() const { return const_cast<Hook*>(&sentinel_); }
+
+  Hook sentinel_;
+  size_t size_{0};
 };
 
 }  // namespace pigeon
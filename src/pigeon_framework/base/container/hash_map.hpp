@@ -0,0 +1,682 @@
+#ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_HASH_MAP
+#define PIGEON_FRAMEWORK_BASE_CONTAINER_HASH_MAP
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "pigeon_framework/base/container/bitwise_search.hpp"
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "pigeon_framework/base/memory/relocate.hpp"
+
+namespace pigeon {
+
+// Default hash. std::hash is the identity for integers on common standard
+// libraries, so its result is mixed to spread the bits the table probes with.
+// Strings hash as std::string_view, which lets tables keyed by std::string be
+// searched with a view or a literal.
+struct Hash {
+  using is_transparent = void;
+
+  // Whether a Q equal to a K also hashes the same. Only strings do; std::hash
+  // of other mixed types, like int64_t and double, differs for equal values.
+  template <typename K, typename Q>
+  static constexpr bool kTransparentFor =
+      std::same_as<K, Q> || (std::convertible_to<const K&, std::string_view> &&
+                             std::convertible_to<const Q&, std::string_view>);
+
+  template <typename K>
+  size_t operator()(const K& key) const {
+    if constexpr (std::convertible_to<const K&, std::string_view>) {
+      return Mix(std::hash<std::string_view>()(key));
+    } else {
+      return Mix(std::hash<K>()(key));
+    }
+  }
+
+  static size_t Mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+  }
+};
+
+template <typename F>
+concept TransparentFunctor = requires { typename F::is_transparent; };
+
+template <typename K>
+concept HashKey = std::movable<K> && std::equality_comparable<K>;
+
+// Element of a HashMap. Keys, here and in a HashSet, must not be changed in
+// place.
+template <HashKey K, std::movable V>
+struct KeyValue {
+  K key_;
+  V value_;
+};
+
+namespace hash_table {
+
+// One control byte per slot. Full slots store the low 7 bits of their hash, so
+// the sign bit tells free slots apart.
+enum Ctrl : int8_t {
+  kEmpty = -128,
+  kDeleted = -2,
+};
+
+inline bool IsFull(int8_t ctrl) { return ctrl >= 0; }
+
+// Bit masks over the 16 control bytes of a group, one bit per slot.
+struct Group {
+  static constexpr size_t kWidth = 16;
+
+#if defined(PIGEON_SIMD_SSE2)
+  explicit Group(const int8_t* ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+  uint32_t Match(int8_t h2) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+  }
+
+  uint32_t MatchEmpty() const { return Match(kEmpty); }
+
+  uint32_t MatchFree() const {
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+  }
+
+  __m128i ctrl_;
+#else
+  explicit Group(const int8_t* ctrl) { std::memcpy(ctrl_, ctrl, kWidth); }
+
+  uint32_t Match(int8_t h2) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kWidth; ++i) {
+      mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+    }
+    return mask;
+  }
+
+  uint32_t MatchEmpty() const { return Match(kEmpty); }
+
+  uint32_t MatchFree() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kWidth; ++i) {
+      mask |= static_cast<uint32_t>(!IsFull(ctrl_[i])) << i;
+    }
+    return mask;
+  }
+
+  int8_t ctrl_[kWidth];
+#endif
+};
+
+// Forward iterator over the full slots.
+template <typename Slot, typename Value>
+class Iterator {
+ public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::forward_iterator_tag;
+  using iterator_type = Iterator;
+  using value_type = std::remove_const_t<Value>;
+  using difference_type = ptrdiff_t;
+  using pointer = Value*;
+  using reference = Value&;
+
+  Iterator() = default;
+
+  Iterator(const int8_t* ctrl, const int8_t* end, Slot* slot)
+      : ctrl_(ctrl), end_(end), slot_(slot) {
+    SkipFree();
+  }
+
+  // Iterator to ConstIterator.
+  template <typename OtherValue>
+    requires std::same_as<const OtherValue, Value>
+  Iterator(const Iterator<Slot, OtherValue>& other)
+      : ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+
+  reference operator*() const { return *slot_; }
+
+  pointer operator->() const { return slot_; }
+
+  iterator_type& operator++() {
+    ++ctrl_;
+    ++slot_;
+    SkipFree();
+    return *this;
+  }
+
+  iterator_type operator++(int) {
+    iterator_type temp(*this);
+    ++(*this);
+    return temp;
+  }
+
+  bool operator==(const iterator_type& other) const {
+    return ctrl_ == other.ctrl_;
+  }
+
+  bool operator!=(const iterator_type& other) const {
+    return !(*this == other);
+  }
+
+  size_t Index(const int8_t* ctrl) const { return ctrl_ - ctrl; }
+
+ private:
+  template <typename OtherSlot, typename OtherValue>
+  friend class Iterator;
+
+  void SkipFree() {
+    while (ctrl_ != end_ && !IsFull(*ctrl_)) {
+      ++ctrl_;
+      ++slot_;
+    }
+  }
+
+  const int8_t* ctrl_{nullptr};
+  const int8_t* end_{nullptr};
+  Slot* slot_{nullptr};
+};
+
+// Flat open-addressing table after Abseil's SwissTable. The hash picks a
+// group of 16 slots to start probing from and a 7-bit tag, and one SIMD
+// compare of the group's control bytes against the tag finds the candidates.
+// Probing stops at the first group with an empty slot. The table grows at a
+// load of 7/8. Policy tells the key of a slot.
+template <typename Policy, typename H, typename E, AsAllocator A>
+class Table {
+ public:
+  using Key = typename Policy::Key;
+  using Slot = typename Policy::Slot;
+  using Iterator = hash_table::Iterator<Slot, Slot>;
+  using ConstIterator = hash_table::Iterator<Slot, const Slot>;
+
+  // Keys other than Key can be looked up as they are when both the hash and
+  // equality are transparent, and the default hash agrees on them.
+  template <typename Q>
+  static constexpr bool kLookup =
+      std::same_as<Q, Key> ||
+      (TransparentFunctor<H> && TransparentFunctor<E> &&
+       !std::convertible_to<const Q&, ConstIterator> &&
+       (!std::same_as<H, Hash> || Hash::kTransparentFor<Key, Q>));
+
+  // Other keys are converted to Key first, like std::unordered_map does.
+  template <typename Q>
+  static constexpr bool kFind =
+      kLookup<Q> || (std::convertible_to<const Q&, Key> &&
+                     !std::convertible_to<const Q&, ConstIterator>);
+
+  Table() = default;
+
+  explicit Table(A allocator) : allocator_(std::move(allocator)) {}
+
+  Table(H hash, E equal = E(), A allocator = A())
+      : allocator_(std::move(allocator)),
+        hash_(std::move(hash)),
+        equal_(std::move(equal)) {}
+
+  Table(const Table& other)
+      : allocator_(other.allocator_),
+        hash_(other.hash_),
+        equal_(other.equal_) {
+    if constexpr (!std::copyable<Slot>) {
+      throw std::invalid_argument("This type is supposed to be copyable.");
+    } else {
+      Reserve(other.size_);
+      for (const Slot& slot : other) {
+        FindOrInsert(Policy::KeyOf(slot), [&slot] { return Slot(slot); });
+      }
+    }
+  }
+
+  Table& operator=(const Table& other) {
+    if (this != &other) {
+      this->~Table();
+      new (this) Table(other);
+    }
+    return *this;
+  }
+
+  Table(Table&& other) noexcept
+      : allocator_(other.allocator_),
+        hash_(other.hash_),
+        equal_(other.equal_),
+        ctrl_(std::exchange(other.ctrl_, nullptr)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0)) {}
+
+  Table& operator=(Table&& other) noexcept {
+    if (this != &other) {
+      this->~Table();
+      new (this) Table(std::move(other));
+    }
+    return *this;
+  }
+
+  ~Table() noexcept { Clear(); }
+
+  template <typename Q>
+    requires kFind<Q>
+  Iterator Find(const Q& key) {
+    return IteratorAt(FindIndex(key));
+  }
+
+  template <typename Q>
+    requires kFind<Q>
+  ConstIterator Find(const Q& key) const {
+    return IteratorAt(FindIndex(key));
+  }
+
+  template <typename Q>
+    requires kFind<Q>
+  bool Contains(const Q& key) const {
+    return FindIndex(key) != capacity_;
+  }
+
+  // Returns whether `key` was there.
+  template <typename Q>
+    requires kFind<Q>
+  bool Erase(const Q& key) {
+    size_t index = FindIndex(key);
+    if (index == capacity_) {
+      return false;
+    }
+    EraseIndex(index);
+    return true;
+  }
+
+  void Erase(ConstIterator pos) {
+    size_t index = pos.Index(ctrl_);
+    if (index >= capacity_) {
+      throw std::out_of_range("Try to erase the end of a table.");
+    }
+    EraseIndex(index);
+  }
+
+  // Returns the number of erased elements.
+  template <std::predicate<Slot&> P>
+  size_t EraseIf(P pred) {
+    size_t size = size_;
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (IsFull(ctrl_[i]) && pred(slots_[i])) {
+        EraseIndex(i);
+      }
+    }
+    return size - size_;
+  }
+
+  // Makes room for `size` elements in total without another rehash.
+  void Reserve(size_t size) {
+    if (size > capacity_ - capacity_ / 8) {
+      Rehash(CapacityFor(size));
+    }
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (IsFull(ctrl_[i])) {
+        slots_[i].~Slot();
+      }
+    }
+    if (ctrl_ != nullptr) {
+      allocator_.Deallocate(ctrl_, AllocSize(capacity_), AllocAlign());
+    }
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    growth_left_ = 0;
+  }
+
+  bool IsEmpty() const { return size_ == 0; }
+
+  size_t Size() const { return size_; }
+
+  size_t Capacity() const { return capacity_; }
+
+  const A& GetAllocator() const { return allocator_; }
+
+  Iterator begin() { return IteratorAt(0); }
+  Iterator end() { return IteratorAt(capacity_); }
+  ConstIterator begin() const { return IteratorAt(0); }
+  ConstIterator end() const { return IteratorAt(capacity_); }
+
+ protected:
+  template <typename Q>
+  size_t FindIndex(const Q& key) const {
+    if constexpr (!kLookup<Q>) {
+      return FindIndex(Key(key));
+    } else {
+      if (size_ == 0) {
+        return capacity_;
+      }
+      return FindIndex(key, hash_(key));
+    }
+  }
+
+  template <typename Q>
+  size_t FindIndex(const Q& key, size_t hash) const {
+    int8_t h2 = static_cast<int8_t>(hash & 0x7f);
+    size_t group_mask = capacity_ / Group::kWidth - 1;
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t step = 1;; ++step) {
+      const int8_t* ctrl = ctrl_ + group * Group::kWidth;
+      Group candidates(ctrl);
+      for (uint32_t mask = candidates.Match(h2); mask != 0;
+           mask &= mask - 1) {
+        size_t index = group * Group::kWidth + std::countr_zero(mask);
+        if (equal_(Policy::KeyOf(slots_[index]), key)) {
+          return index;
+        }
+      }
+      if (candidates.MatchEmpty() != 0) {
+        return capacity_;
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  // Finds `key`, or inserts the element returned by `make`, which is only
+  // called when `key` is missing. Returns the index and whether it inserted.
+  // A growing table makes the element before moving the old slots, so `key`
+  // and `make` may refer into it.
+  template <typename Q, std::invocable F>
+  std::pair<size_t, bool> FindOrInsert(const Q& key, F&& make) {
+    size_t hash = hash_(key);
+    size_t index = size_ == 0 ? capacity_ : FindIndex(key, hash);
+    if (index != capacity_) {
+      return {index, false};
+    }
+    if (capacity_ != 0) {
+      index = FindFree(hash);
+    }
+    if (capacity_ == 0 || (growth_left_ == 0 && ctrl_[index] != kDeleted)) {
+      Slot slot(make());
+      Grow();
+      index = FindFree(hash);
+      new (slots_ + index) Slot(std::move(slot));
+    } else {
+      new (slots_ + index) Slot(make());
+    }
+    if (ctrl_[index] == kEmpty) {
+      --growth_left_;
+    }
+    ctrl_[index] = static_cast<int8_t>(hash & 0x7f);
+    ++size_;
+    return {index, true};
+  }
+
+  void EraseIndex(size_t index) {
+    slots_[index].~Slot();
+    --size_;
+    // A group that has an empty slot ends every probe reaching it, so the
+    // slot can become empty again instead of a tombstone.
+    size_t group = index / Group::kWidth * Group::kWidth;
+    if (Group(ctrl_ + group).MatchEmpty() != 0) {
+      ctrl_[index] = kEmpty;
+      ++growth_left_;
+    } else {
+      ctrl_[index] = kDeleted;
+    }
+  }
+
+  Iterator IteratorAt(size_t index) {
+    return Iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+  }
+
+  ConstIterator IteratorAt(size_t index) const {
+    return ConstIterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+  }
+
+  Slot* SlotAt(size_t index) const { return slots_ + index; }
+
+ private:
+  // Smallest power of two, at least a group, holding `size` elements at the
+  // maximum load.
+  static size_t CapacityFor(size_t size) {
+    size_t capacity = Group::kWidth;
+    while (size > capacity - capacity / 8) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  // Control bytes first, then the slots.
+  static size_t SlotOffset(size_t capacity) {
+    return (capacity + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+  }
+
+  static size_t AllocSize(size_t capacity) {
+    return SlotOffset(capacity) + capacity * sizeof(Slot);
+  }
+
+  static size_t AllocAlign() {
+    return alignof(Slot) > Group::kWidth ? alignof(Slot) : Group::kWidth;
+  }
+
+  size_t FindFree(size_t hash) const {
+    size_t group_mask = capacity_ / Group::kWidth - 1;
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t step = 1;; ++step) {
+      uint32_t mask = Group(ctrl_ + group * Group::kWidth).MatchFree();
+      if (mask != 0) {
+        return group * Group::kWidth + std::countr_zero(mask);
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  void Grow() {
+    if (capacity_ == 0) {
+      Rehash(CapacityFor(1));
+      return;
+    }
+    // Tombstones alone may fill the table, so only grow when live elements
+    // need the room.
+    size_t capacity = capacity_;
+    if (size_ + 1 > capacity / 2 - capacity / 16) {
+      capacity = CapacityFor(size_ + 1);
+    }
+    Rehash(capacity);
+  }
+
+  void Rehash(size_t capacity) {
+    int8_t* old_ctrl = ctrl_;
+    Slot* old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_ = static_cast<int8_t*>(
+        allocator_.Allocate(AllocSize(capacity), AllocAlign()));
+    slots_ = reinterpret_cast<Slot*>(ctrl_ + SlotOffset(capacity));
+    capacity_ = capacity;
+    growth_left_ = capacity - capacity / 8 - size_;
+    std::memset(ctrl_, kEmpty, capacity);
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (!IsFull(old_ctrl[i])) {
+        continue;
+      }
+      size_t hash = hash_(Policy::KeyOf(old_slots[i]));
+      size_t index = FindFree(hash);
+      ctrl_[index] = static_cast<int8_t>(hash & 0x7f);
+      RelocateRange(old_slots + i, 1, slots_ + index);
+    }
+    if (old_ctrl != nullptr) {
+      allocator_.Deallocate(old_ctrl, AllocSize(old_capacity), AllocAlign());
+    }
+  }
+
+  [[no_unique_address]] A allocator_;
+  [[no_unique_address]] H hash_;
+  [[no_unique_address]] E equal_;
+  int8_t* ctrl_{nullptr};
+  Slot* slots_{nullptr};
+  size_t size_{0};
+  size_t capacity_{0};
+  size_t growth_left_{0};
+};
+
+template <typename K, typename V>
+struct MapPolicy {
+  using Key = K;
+  using Slot = KeyValue<K, V>;
+
+  static const K& KeyOf(const Slot& slot) { return slot.key_; }
+};
+
+template <typename K>
+struct SetPolicy {
+  using Key = K;
+  using Slot = K;
+
+  static const K& KeyOf(const K& slot) { return slot; }
+};
+
+}  // namespace hash_table
+
+// Flat hash map. Elements live inline in one allocation, so growing moves
+// them and invalidates pointers and iterators.
+template <HashKey K, std::movable V, typename H = Hash,
+          typename E = std::equal_to<>, AsAllocator A = HeapAllocator>
+class HashMap
+    : public hash_table::Table<hash_table::MapPolicy<K, V>, H, E, A> {
+  using Base = hash_table::Table<hash_table::MapPolicy<K, V>, H, E, A>;
+
+ public:
+  using Base::Base;
+  using typename Base::Iterator;
+
+  HashMap(std::initializer_list<KeyValue<K, V>> list, A allocator = A())
+      : Base(std::move(allocator)) {
+    this->Reserve(list.size());
+    for (const KeyValue<K, V>& item : list) {
+      Insert(item.key_, item.value_);
+    }
+  }
+
+  // Inserts a default value if `key` is missing.
+  V& operator[](const K& key)
+    requires std::default_initializable<V>
+  {
+    return Emplace(key).first->value_;
+  }
+
+  template <typename Q>
+    requires Base::template kFind<Q>
+  V& At(const Q& key) {
+    size_t index = this->FindIndex(key);
+    if (index == this->Capacity()) {
+      throw std::out_of_range("Key is not in the map.");
+    }
+    return this->SlotAt(index)->value_;
+  }
+
+  template <typename Q>
+    requires Base::template kFind<Q>
+  const V& At(const Q& key) const {
+    size_t index = this->FindIndex(key);
+    if (index == this->Capacity()) {
+      throw std::out_of_range("Key is not in the map.");
+    }
+    return this->SlotAt(index)->value_;
+  }
+
+  // Constructs the value from `args` only if `key` is missing. Returns the
+  // element and whether it was inserted.
+  template <typename Q, typename... Args>
+    requires std::constructible_from<K, Q&&>
+  std::pair<Iterator, bool> Emplace(Q&& key, Args&&... args) {
+    if constexpr (!Base::template kLookup<std::remove_cvref_t<Q>>) {
+      return Emplace(K(std::forward<Q>(key)), std::forward<Args>(args)...);
+    } else {
+      auto [index, inserted] = this->FindOrInsert(key, [&] {
+        return KeyValue<K, V>{K(std::forward<Q>(key)),
+                              V(std::forward<Args>(args)...)};
+      });
+      return {this->IteratorAt(index), inserted};
+    }
+  }
+
+  // Leaves an existing value alone, returns whether `val` was inserted.
+  bool Insert(const K& key, const V& val) { return Emplace(key, val).second; }
+
+  bool Insert(K&& key, V&& val) {
+    return Emplace(std::move(key), std::move(val)).second;
+  }
+
+  // Overwrites an existing value, returns whether `key` was new.
+  bool InsertOrAssign(K key, V val) {
+    auto [it, inserted] = Emplace(std::move(key), std::move(val));
+    if (!inserted) {
+      it->value_ = std::move(val);
+    }
+    return inserted;
+  }
+
+  // Takes the value of `key` out of the map.
+  template <typename Q>
+    requires Base::template kFind<Q>
+  std::optional<V> Remove(const Q& key) {
+    size_t index = this->FindIndex(key);
+    if (index == this->Capacity()) {
+      return std::nullopt;
+    }
+    std::optional<V> val(std::move(this->SlotAt(index)->value_));
+    this->EraseIndex(index);
+    return val;
+  }
+};
+
+// Flat hash set with the same layout and rules as HashMap.
+template <HashKey K, typename H = Hash, typename E = std::equal_to<>,
+          AsAllocator A = HeapAllocator>
+class HashSet : public hash_table::Table<hash_table::SetPolicy<K>, H, E, A> {
+  using Base = hash_table::Table<hash_table::SetPolicy<K>, H, E, A>;
+
+ public:
+  using Base::Base;
+  using typename Base::Iterator;
+
+  HashSet(std::initializer_list<K> list, A allocator = A())
+      : Base(std::move(allocator)) {
+    this->Reserve(list.size());
+    for (const K& key : list) {
+      Insert(key);
+    }
+  }
+
+  template <typename Q>
+    requires std::constructible_from<K, Q&&>
+  std::pair<Iterator, bool> Emplace(Q&& key) {
+    if constexpr (!Base::template kLookup<std::remove_cvref_t<Q>>) {
+      return Emplace(K(std::forward<Q>(key)));
+    } else {
+      auto [index, inserted] = this->FindOrInsert(
+          key, [&key] { return K(std::forward<Q>(key)); });
+      return {this->IteratorAt(index), inserted};
+    }
+  }
+
+  // Returns whether `key` was new.
+  bool Insert(const K& key) { return Emplace(key).second; }
+
+  bool Insert(K&& key) { return Emplace(std::move(key)).second; }
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_HASH_MAP
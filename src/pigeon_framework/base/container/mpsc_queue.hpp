@@ -0,0 +1,90 @@
+#ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_MPSC_QUEUE
+#define PIGEON_FRAMEWORK_BASE_CONTAINER_MPSC_QUEUE
+
+#include <atomic>
+#include <concepts>
+
+namespace pigeon {
+
+// Hook for types queued in an MpscQueue. Copies are not linked anywhere.
+class MpscNode {
+ public:
+  MpscNode() = default;
+  MpscNode(const MpscNode&) {}
+  MpscNode& operator=(const MpscNode&) { return *this; }
+
+ private:
+  template <typename T>
+    requires std::derived_from<T, MpscNode>
+  friend class MpscQueue;
+
+  std::atomic<MpscNode*> next_{nullptr};
+};
+
+// Intrusive unbounded multi-producer single-consumer queue by Dmitry Vyukov.
+// Push is wait-free and never allocates, Pop is lock-free but may miss an
+// item whose Push is still in progress. The queue doesn't own its items.
+template <typename T>
+  requires std::derived_from<T, MpscNode>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  MpscQueue(const MpscQueue& other) = delete;
+  MpscQueue& operator=(const MpscQueue& other) = delete;
+
+  // Any thread.
+  void Push(T* item) { Push(static_cast<MpscNode*>(item)); }
+
+  // Consumer thread only, nullptr when empty.
+  T* Pop() {
+    MpscNode* tail = tail_;
+    MpscNode* next = tail->next_.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // A producer has swapped the head but not linked its node yet.
+      return nullptr;
+    }
+    // Tail is the last item, put the stub behind it to be able to unlink it.
+    Push(&stub_);
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+    return nullptr;
+  }
+
+  // Consumer thread only.
+  bool IsEmpty() const {
+    MpscNode* tail = tail_;
+    return tail == &stub_ &&
+           tail->next_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  void Push(MpscNode* node) {
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next_.store(node, std::memory_order_release);
+  }
+
+  alignas(64) std::atomic<MpscNode*> head_;
+  alignas(64) MpscNode* tail_;
+  MpscNode stub_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_MPSC_QUEUE
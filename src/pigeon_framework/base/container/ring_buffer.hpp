@@ -0,0 +1,303 @@
+#ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_RING_BUFFER
+#define PIGEON_FRAMEWORK_BASE_CONTAINER_RING_BUFFER
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "pigeon_framework/base/memory/allocator.hpp"
+
+namespace pigeon {
+
+// Values must move without throwing, so that a claimed slot always gets
+// filled.
+template <typename T>
+concept RingValue = std::movable<T> && std::is_nothrow_move_constructible_v<T>;
+
+// Smallest power of two holding `capacity`, at least 2.
+inline size_t RingCapacity(size_t capacity) {
+  size_t power = 2;
+  while (power < capacity) {
+    power *= 2;
+  }
+  return power;
+}
+
+// Bounded wait-free queue for exactly one producer and one consumer thread.
+// The capacity is rounded up to a power of two and allocated once. Each side
+// caches the other side's index and only reloads it when the queue looks
+// full or empty.
+template <RingValue T, AsAllocator A = HeapAllocator>
+class SpscRingBuffer {
+ public:
+  explicit SpscRingBuffer(size_t capacity, A allocator = A())
+      : allocator_(allocator), mask_(RingCapacity(capacity) - 1) {
+    slots_ = static_cast<T*>(
+        allocator_.Allocate(sizeof(T) * Capacity(), alignof(T)));
+  }
+
+  SpscRingBuffer(const SpscRingBuffer& other) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer& other) = delete;
+
+  ~SpscRingBuffer() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      slots_[i & mask_].~T();
+    }
+    allocator_.Deallocate(slots_, sizeof(T) * Capacity(), alignof(T));
+  }
+
+  // Producer thread only, false when full.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (FreeCnt(tail, 1) == 0) {
+      return false;
+    }
+    new (slots_ + (tail & mask_)) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPush(T&& val) { return TryEmplace(std::move(val)); }
+
+  bool TryPush(const T& val) { return TryEmplace(val); }
+
+  // Producer thread only. Moves as many items from the front of `items` as
+  // fit, and returns how many.
+  size_t PushBatch(std::span<T> items) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t cnt = std::min(items.size(), FreeCnt(tail, items.size()));
+    for (size_t i = 0; i < cnt; ++i) {
+      new (slots_ + ((tail + i) & mask_)) T(std::move(items[i]));
+    }
+    tail_.store(tail + cnt, std::memory_order_release);
+    return cnt;
+  }
+
+  // Consumer thread only.
+  std::optional<T> TryPop() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (ReadyCnt(head, 1) == 0) {
+      return std::nullopt;
+    }
+    T& slot = slots_[head & mask_];
+    std::optional<T> val(std::move(slot));
+    slot.~T();
+    head_.store(head + 1, std::memory_order_release);
+    return val;
+  }
+
+  // Consumer thread only. Hands at most `max_cnt` items to `sink`, returns
+  // how many it did.
+  template <std::invocable<T&&> F>
+  size_t PopBatch(F&& sink, size_t max_cnt = SIZE_MAX) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t cnt = std::min(max_cnt, ReadyCnt(head, max_cnt));
+    for (size_t i = 0; i < cnt; ++i) {
+      T& slot = slots_[(head + i) & mask_];
+      sink(std::move(slot));
+      slot.~T();
+    }
+    head_.store(head + cnt, std::memory_order_release);
+    return cnt;
+  }
+
+  // Exact on either thread only while the other one is idle.
+  size_t Size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  size_t FreeCnt(size_t tail, size_t wanted) {
+    if (Capacity() - (tail - head_cache_) < wanted) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+    }
+    return Capacity() - (tail - head_cache_);
+  }
+
+  size_t ReadyCnt(size_t head, size_t wanted) {
+    if (tail_cache_ - head < wanted) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+    }
+    return tail_cache_ - head;
+  }
+
+  [[no_unique_address]] A allocator_;
+  size_t mask_;
+  T* slots_;
+
+  // Consumer side.
+  alignas(64) std::atomic_size_t head_{0};
+  size_t tail_cache_{0};
+
+  // Producer side.
+  alignas(64) std::atomic_size_t tail_{0};
+  size_t head_cache_{0};
+};
+
+// Bounded lock-free queue for any number of producer and consumer threads,
+// after Dmitry Vyukov's design. Every slot carries a sequence number telling
+// whether it is ready to be written or read in the current lap, so threads
+// only contend on the two indices.
+template <RingValue T, AsAllocator A = HeapAllocator>
+class MpmcRingBuffer {
+ public:
+  explicit MpmcRingBuffer(size_t capacity, A allocator = A())
+      : allocator_(allocator), mask_(RingCapacity(capacity) - 1) {
+    cells_ = static_cast<Cell*>(
+        allocator_.Allocate(sizeof(Cell) * Capacity(), alignof(Cell)));
+    for (size_t i = 0; i < Capacity(); ++i) {
+      new (cells_ + i) Cell();
+      cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer& other) = delete;
+  MpmcRingBuffer& operator=(const MpmcRingBuffer& other) = delete;
+
+  ~MpmcRingBuffer() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      cells_[i & mask_].Value()->~T();
+    }
+    for (size_t i = 0; i < Capacity(); ++i) {
+      cells_[i].~Cell();
+    }
+    allocator_.Deallocate(cells_, sizeof(Cell) * Capacity(), alignof(Cell));
+  }
+
+  // False when full. The value is built before a slot is claimed, only a
+  // moved T goes straight into the slot.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    if constexpr (sizeof...(Args) == 1 && (std::same_as<Args, T> && ...)) {
+      return PushOne(std::forward<Args>(args)...);
+    } else {
+      return PushOne(T(std::forward<Args>(args)...));
+    }
+  }
+
+  bool TryPush(T&& val) { return PushOne(std::move(val)); }
+
+  bool TryPush(const T& val) { return TryEmplace(val); }
+
+  // Moves as many items from the front of `items` as fit, and returns how
+  // many. The items land next to each other in the queue.
+  size_t PushBatch(std::span<T> items) {
+    size_t pos;
+    size_t cnt = Claim(tail_, 0, items.size(), pos);
+    for (size_t i = 0; i < cnt; ++i) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      new (cell.storage_) T(std::move(items[i]));
+      cell.sequence_.store(pos + i + 1, std::memory_order_release);
+    }
+    return cnt;
+  }
+
+  std::optional<T> TryPop() {
+    std::optional<T> val;
+    PopBatch([&val](T&& item) { val.emplace(std::move(item)); }, 1);
+    return val;
+  }
+
+  // Hands at most `max_cnt` items to `sink`, returns how many it did.
+  template <std::invocable<T&&> F>
+  size_t PopBatch(F&& sink, size_t max_cnt = SIZE_MAX) {
+    size_t pos;
+    size_t cnt = Claim(head_, 1, max_cnt, pos);
+    for (size_t i = 0; i < cnt; ++i) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      T* val = cell.Value();
+      sink(std::move(*val));
+      val->~T();
+      cell.sequence_.store(pos + i + Capacity(), std::memory_order_release);
+    }
+    return cnt;
+  }
+
+  // Only a snapshot while other threads are active.
+  size_t Size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic_size_t sequence_;
+    alignas(T) std::byte storage_[sizeof(T)];
+
+    T* Value() { return std::launder(reinterpret_cast<T*>(storage_)); }
+  };
+
+  template <typename U>
+  bool PushOne(U&& val) {
+    size_t pos;
+    if (Claim(tail_, 0, 1, pos) == 0) {
+      return false;
+    }
+    Cell& cell = cells_[pos & mask_];
+    new (cell.storage_) T(std::forward<U>(val));
+    cell.sequence_.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Claims up to `max_cnt` consecutive cells from `index`, whose sequence is
+  // their position plus `lap` when they are ready for this side.
+  size_t Claim(std::atomic_size_t& index, size_t lap, size_t max_cnt,
+               size_t& pos) {
+    pos = index.load(std::memory_order_relaxed);
+    while (true) {
+      size_t cnt = 0;
+      while (cnt < max_cnt && cnt < Capacity()) {
+        size_t sequence = cells_[(pos + cnt) & mask_].sequence_.load(
+            std::memory_order_acquire);
+        if (sequence != pos + cnt + lap) {
+          break;
+        }
+        ++cnt;
+      }
+      if (cnt == 0) {
+        size_t sequence =
+            cells_[pos & mask_].sequence_.load(std::memory_order_acquire);
+        // Behind the index means full or empty, ahead means another thread
+        // took the cell, so retry from the new index.
+        if (static_cast<ptrdiff_t>(sequence - (pos + lap)) < 0) {
+          return 0;
+        }
+        pos = index.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (index.compare_exchange_weak(pos, pos + cnt,
+                                      std::memory_order_relaxed)) {
+        return cnt;
+      }
+    }
+  }
+
+  [[no_unique_address]] A allocator_;
+  size_t mask_;
+  Cell* cells_;
+
+  alignas(64) std::atomic_size_t head_{0};
+  alignas(64) std::atomic_size_t tail_{0};
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_RING_BUFFER
@@ -0,0 +1,139 @@
+#ifndef PIGEON_FRAMEWORK_BASE_CONTAINER_WORK_STEALING_DEQUE
+#define PIGEON_FRAMEWORK_BASE_CONTAINER_WORK_STEALING_DEQUE
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+
+namespace pigeon {
+
+// Chase-Lev deque. The owner thread pushes and pops at the bottom, any other
+// thread may steal from the top. Buffers replaced by growth are kept until the
+// deque is destroyed, since a thief may still be reading from them.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity = 64) {
+    size_t power = 1;
+    while (power < capacity) {
+      power *= 2;
+    }
+    buffers_.EmplaceBack(Owned<Buffer>::New(power));
+    buffer_.store(buffers_[0].Get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque& other) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+  void Push(T item) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top >= static_cast<int64_t>(buffer->Capacity())) {
+      buffer = Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  std::optional<T> Pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    T item = buffer->Get(bottom);
+    if (top == bottom) {
+      // Last item, race the thieves for it.
+      bool won = top_.compare_exchange_strong(top, top + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      if (!won) {
+        return std::nullopt;
+      }
+    }
+    return item;
+  }
+
+  // May fail spuriously when another thread takes the same item.
+  std::optional<T> Steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return std::nullopt;
+    }
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T item = buffer->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    return item;
+  }
+
+  size_t Size() const {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+ private:
+  class Buffer {
+   public:
+    explicit Buffer(size_t capacity)
+        : mask_(capacity - 1), items_(new std::atomic<T>[capacity]) {}
+
+    Buffer(const Buffer& other) = delete;
+    Buffer& operator=(const Buffer& other) = delete;
+
+    ~Buffer() { delete[] items_; }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    T Get(int64_t index) const {
+      return items_[static_cast<size_t>(index) & mask_].load(
+          std::memory_order_relaxed);
+    }
+
+    void Put(int64_t index, T item) {
+      items_[static_cast<size_t>(index) & mask_].store(
+          item, std::memory_order_relaxed);
+    }
+
+   private:
+    size_t mask_;
+    std::atomic<T>* items_;
+  };
+
+  Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom) {
+    buffers_.EmplaceBack(Owned<Buffer>::New(2 * buffer->Capacity()));
+    Buffer* grown = buffers_[buffers_.Size() - 1].Get();
+    for (int64_t i = top; i < bottom; ++i) {
+      grown->Put(i, buffer->Get(i));
+    }
+    buffer_.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Buffer*> buffer_{nullptr};
+  Array<Owned<Buffer>> buffers_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_CONTAINER_WORK_STEALING_DEQUE
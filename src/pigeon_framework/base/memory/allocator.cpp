@@ -0,0 +1,23 @@
+#include "pigeon_framework/base/memory/allocator.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+class HeapResource : public MemoryResource {
+ public:
+  void* Allocate(size_t size, size_t align) override {
+    return HeapAllocator().Allocate(size, align);
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t align) override {
+    HeapAllocator().Deallocate(ptr, size, align);
+  }
+};
+
+}  // namespace
+
+MemoryResource* MemoryResource::Heap() {
+  static HeapResource resource;
+  return &resource;
+}
@@ -0,0 +1,109 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_ALLOCATOR
+#define PIGEON_FRAMEWORK_BASE_MEMORY_ALLOCATOR
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// Allocators are cheap handles copied into every container or pointer that
+// allocates through them. Stateless allocators take no space in their owners.
+template <typename A>
+concept AsAllocator =
+    std::copyable<A> && requires(A allocator, void* ptr, size_t size,
+                                 size_t align) {
+      { allocator.Allocate(size, align) } -> std::same_as<void*>;
+      { allocator.Deallocate(ptr, size, align) } -> std::same_as<void>;
+    };
+
+struct HeapAllocator {
+  void* Allocate(size_t size, size_t align) {
+#if defined(PIGEON_TRACK_MEMORY)
+    return TrackedAllocate(size, align);
+#else
+    return ::operator new(size, std::align_val_t(align));
+#endif
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t align) {
+#if defined(PIGEON_TRACK_MEMORY)
+    TrackedDeallocate(ptr, size, align);
+#else
+    ::operator delete(ptr, size, std::align_val_t(align));
+#endif
+  }
+
+  bool operator==(const HeapAllocator&) const = default;
+};
+
+// Runtime-selected memory region, for subsystems that pick their arena or pool
+// without templating every container on it.
+class PIGEON_API MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+  virtual void* Allocate(size_t size, size_t align) = 0;
+  virtual void Deallocate(void* ptr, size_t size, size_t align) = 0;
+
+  static MemoryResource* Heap();
+};
+
+class ResourceAllocator {
+ public:
+  ResourceAllocator() : resource_(MemoryResource::Heap()) {}
+
+  ResourceAllocator(MemoryResource* resource) : resource_(resource) {}
+
+  void* Allocate(size_t size, size_t align) {
+    return resource_->Allocate(size, align);
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t align) {
+    resource_->Deallocate(ptr, size, align);
+  }
+
+  MemoryResource* Resource() const { return resource_; }
+
+  bool operator==(const ResourceAllocator&) const = default;
+
+ private:
+  MemoryResource* resource_;
+};
+
+template <typename T, AsAllocator A, typename... Args>
+T* NewObject(A& allocator, Args&&... args) {
+  void* ptr = allocator.Allocate(sizeof(T), alignof(T));
+  try {
+    return new (ptr) T(std::forward<Args>(args)...);
+  } catch (...) {
+    allocator.Deallocate(ptr, sizeof(T), alignof(T));
+    throw;
+  }
+}
+
+template <typename T, AsAllocator A>
+void DeleteObject(A& allocator, T* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  ptr->~T();
+  allocator.Deallocate(ptr, sizeof(T), alignof(T));
+}
+
+template <typename T, AsAllocator A>
+struct AllocatorDelete {
+  AllocatorDelete() = default;
+
+  explicit AllocatorDelete(A allocator) : allocator_(std::move(allocator)) {}
+
+  void operator()(T* ptr) { DeleteObject(allocator_, ptr); }
+
+  [[no_unique_address]] A allocator_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_ALLOCATOR
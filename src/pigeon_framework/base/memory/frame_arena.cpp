@@ -0,0 +1,166 @@
+#include "pigeon_framework/base/memory/frame_arena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+using namespace pigeon;
+
+namespace {
+
+std::atomic<uint64_t> global_frame{0};
+std::atomic<const void*> frame_owner{nullptr};
+
+struct Chunk {
+  Chunk* next_;
+  size_t size_;
+
+  static constexpr size_t kHeaderSize = 64;
+
+  std::byte* Begin() {
+    return reinterpret_cast<std::byte*>(this) + kHeaderSize;
+  }
+
+  std::byte* End() { return Begin() + size_; }
+};
+
+std::byte* AlignUp(std::byte* ptr, size_t align) {
+  auto address = reinterpret_cast<uintptr_t>(ptr);
+  return ptr + ((align - address % align) % align);
+}
+
+class Buffer {
+ public:
+  Buffer() = default;
+
+  Buffer(const Buffer& other) = delete;
+  Buffer& operator=(const Buffer& other) = delete;
+
+  ~Buffer() {
+    while (first_ != nullptr) {
+      Chunk* chunk = first_;
+      first_ = chunk->next_;
+      HeapAllocator().Deallocate(chunk, Chunk::kHeaderSize + chunk->size_,
+                                 alignof(Chunk));
+    }
+  }
+
+  void* Allocate(size_t size, size_t align) {
+    std::byte* ptr = nullptr;
+    if (cursor_ != nullptr) {
+      ptr = AlignUp(cursor_, align);
+      if (ptr > current_->End() ||
+          static_cast<size_t>(current_->End() - ptr) < size) {
+        ptr = nullptr;
+      }
+    }
+    if (ptr == nullptr) {
+      ptr = AllocateSlow(size, align);
+    }
+    cursor_ = ptr + size;
+    used_ += size;
+    return ptr;
+  }
+
+  void Deallocate(void* ptr, size_t size) {
+    if (static_cast<std::byte*>(ptr) + size == cursor_) {
+      cursor_ = static_cast<std::byte*>(ptr);
+      used_ -= size;
+    }
+  }
+
+  void Reset() {
+    current_ = first_;
+    cursor_ = first_ == nullptr ? nullptr : first_->Begin();
+    used_ = 0;
+  }
+
+  size_t Used() const { return used_; }
+
+  size_t Reserved() const { return reserved_; }
+
+ private:
+  // Moves on to the next chunk that fits, or links in a new one after the
+  // current chunk.
+  std::byte* AllocateSlow(size_t size, size_t align) {
+    size_t needed = size + align;
+    Chunk* prev = current_;
+    Chunk* next = current_ == nullptr ? first_ : current_->next_;
+    if (next == nullptr || next->size_ < needed) {
+      size_t chunk_size = std::max(needed, FrameArena::kChunkSize);
+      auto* chunk = static_cast<Chunk*>(HeapAllocator().Allocate(
+          Chunk::kHeaderSize + chunk_size, alignof(Chunk)));
+      chunk->next_ = next;
+      chunk->size_ = chunk_size;
+      reserved_ += chunk_size;
+      (prev == nullptr ? first_ : prev->next_) = chunk;
+      next = chunk;
+    }
+    current_ = next;
+    return AlignUp(next->Begin(), align);
+  }
+
+  Chunk* first_{nullptr};
+  Chunk* current_{nullptr};
+  std::byte* cursor_{nullptr};
+  size_t used_{0};
+  size_t reserved_{0};
+};
+
+struct ThreadArena {
+  Buffer buffers_[2];
+  uint64_t frame_{0};
+
+  // Catches up with the global frame, resetting the buffers that expired.
+  Buffer& Current() {
+    uint64_t now = global_frame.load(std::memory_order_acquire);
+    if (now != frame_) {
+      buffers_[now % 2].Reset();
+      if (now - frame_ > 1) {
+        buffers_[(now + 1) % 2].Reset();
+      }
+      frame_ = now;
+    }
+    return buffers_[now % 2];
+  }
+};
+
+thread_local ThreadArena tls_arena;
+
+}  // namespace
+
+void* FrameArena::Allocate(size_t size, size_t align) {
+  return tls_arena.Current().Allocate(size, align);
+}
+
+void FrameArena::Deallocate(void* ptr, size_t size) {
+  tls_arena.Current().Deallocate(ptr, size);
+}
+
+void FrameArena::NextFrame() {
+  global_frame.fetch_add(1, std::memory_order_release);
+}
+
+void FrameArena::Claim(const void* owner) {
+  const void* expected = nullptr;
+  if (!frame_owner.compare_exchange_strong(expected, owner,
+                                           std::memory_order_acq_rel)) {
+    throw std::invalid_argument(
+        "Only one Application is supposed to exist at a time.");
+  }
+}
+
+void FrameArena::Release(const void* owner) {
+  const void* expected = owner;
+  frame_owner.compare_exchange_strong(expected, nullptr,
+                                      std::memory_order_acq_rel);
+}
+
+uint64_t FrameArena::Frame() {
+  return global_frame.load(std::memory_order_acquire);
+}
+
+size_t FrameArena::UsedBytes() { return tls_arena.Current().Used(); }
+
+size_t FrameArena::ReservedBytes() {
+  return tls_arena.buffers_[0].Reserved() + tls_arena.buffers_[1].Reserved();
+}
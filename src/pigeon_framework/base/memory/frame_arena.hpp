@@ -0,0 +1,68 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_FRAME_ARENA
+#define PIGEON_FRAMEWORK_BASE_MEMORY_FRAME_ARENA
+
+#include <cstddef>
+#include <cstdint>
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// Bump allocator for data thrown away at the end of a frame. Every thread has
+// two buffers and allocates from the one of the current frame; NextFrame
+// switches all threads over and the buffer two frames old is reset in O(1).
+// Memory therefore stays valid during the frame it was allocated in and the
+// next one. Buffers are chunk lists kept across resets, so once they have
+// grown to a frame's needs, allocating is only a pointer bump.
+//
+// Frames are process-wide, so only one Application may advance them. A
+// second Application alive at the same time throws when constructed, rather
+// than resetting buffers in the middle of the first one's frame.
+class PIGEON_API FrameArena {
+ public:
+  static constexpr size_t kChunkSize = 256 * 1024;
+
+  // Any size and power-of-two alignment, from the calling thread's buffer.
+  static void* Allocate(size_t size, size_t align);
+
+  // Only gives back the memory if it is the latest allocation of the calling
+  // thread, e.g. a scratch Array destroyed right after use.
+  static void Deallocate(void* ptr, size_t size);
+
+  // Called by Application at the start of every frame.
+  static void NextFrame();
+
+  // Makes `owner` the only one advancing frames until it calls Release.
+  // Throws if another owner holds the arena.
+  static void Claim(const void* owner);
+  static void Release(const void* owner);
+
+  static uint64_t Frame();
+
+  // Bytes the calling thread has allocated in the current frame.
+  static size_t UsedBytes();
+
+  // Bytes held by the calling thread's two buffers.
+  static size_t ReservedBytes();
+};
+
+struct FrameAllocator {
+  void* Allocate(size_t size, size_t align) {
+    return FrameArena::Allocate(size, align);
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t) {
+    FrameArena::Deallocate(ptr, size);
+  }
+
+  bool operator==(const FrameAllocator&) const = default;
+};
+
+// Scratch array that must not outlive the next frame.
+template <ArrayValue T>
+using FrameArray = Array<T, FrameAllocator>;
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_FRAME_ARENA
@@ -0,0 +1,357 @@
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+using namespace pigeon;
+
+namespace {
+
+// Own cache lines, so threads never write to the same one.
+struct alignas(64) Counters {
+  std::atomic<uint64_t> alloc_cnt_[MemoryTracker::kMaxTagCnt]{};
+  std::atomic<uint64_t> free_cnt_[MemoryTracker::kMaxTagCnt]{};
+  std::atomic<uint64_t> alloc_bytes_[MemoryTracker::kMaxTagCnt]{};
+  std::atomic<uint64_t> free_bytes_[MemoryTracker::kMaxTagCnt]{};
+  // Set when the owning thread exits.
+  std::atomic_bool retired_{false};
+
+  void Add(const Counters& other) {
+    for (size_t i = 0; i < MemoryTracker::kMaxTagCnt; ++i) {
+      Add(alloc_cnt_[i], other.alloc_cnt_[i]);
+      Add(free_cnt_[i], other.free_cnt_[i]);
+      Add(alloc_bytes_[i], other.alloc_bytes_[i]);
+      Add(free_bytes_[i], other.free_bytes_[i]);
+    }
+  }
+
+  static void Add(std::atomic<uint64_t>& to,
+                  const std::atomic<uint64_t>& from) {
+    to.fetch_add(from.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+  }
+};
+
+// Never destroyed, memory is still freed during static destruction. Its own
+// bookkeeping is allocated while tracking, so it is never counted.
+struct Registry {
+  std::mutex mutex_;
+  std::vector<Counters*> threads_;
+  // Shared by exited threads and threads whose counters are gone.
+  Counters retired_;
+  const char* names_[MemoryTracker::kMaxTagCnt]{"General", "Tasks", "Timers"};
+  size_t tag_cnt_{3};
+  // Live bytes as far as threads have published them, see AddLive.
+  std::atomic<int64_t> published_bytes_[MemoryTracker::kMaxTagCnt]{};
+  std::atomic<uint64_t> peak_bytes_[MemoryTracker::kMaxTagCnt]{};
+
+  // Not from the heap, which may be what is asking for it.
+  static Registry& Get() {
+    alignas(Registry) static std::byte storage[sizeof(Registry)];
+    static Registry* registry = new (storage) Registry();
+    return *registry;
+  }
+
+  // Folds exited threads into retired_. Requires mutex_.
+  void Compact() {
+    std::erase_if(threads_, [this](Counters* counters) {
+      if (!counters->retired_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      retired_.Add(*counters);
+      delete counters;
+      return true;
+    });
+  }
+
+  using Field = std::atomic<uint64_t> (Counters::*)[MemoryTracker::kMaxTagCnt];
+
+  uint64_t Sum(Field field, MemoryTag tag) {
+    uint64_t sum = (retired_.*field)[tag].load(std::memory_order_relaxed);
+    for (Counters* counters : threads_) {
+      sum += (counters->*field)[tag].load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+};
+
+thread_local MemoryTag tls_tag = kMemoryTagGeneral;
+thread_local Counters* tls_counters = nullptr;
+// Live bytes of this thread not yet added to published_bytes_.
+thread_local int64_t tls_unpublished[MemoryTracker::kMaxTagCnt]{};
+thread_local bool tls_exited = false;
+// Set while the tracker itself runs, whose allocations are not counted.
+thread_local bool tls_tracking = false;
+
+class TrackingScope {
+ public:
+  TrackingScope() : outer_(std::exchange(tls_tracking, true)) {}
+
+  TrackingScope(const TrackingScope& other) = delete;
+  TrackingScope& operator=(const TrackingScope& other) = delete;
+
+  ~TrackingScope() { tls_tracking = outer_; }
+
+ private:
+  bool outer_;
+};
+
+void RaisePeak(MemoryTag tag, int64_t live) {
+  std::atomic<uint64_t>& peak = Registry::Get().peak_bytes_[tag];
+  uint64_t old_peak = peak.load(std::memory_order_relaxed);
+  while (live > 0 && old_peak < static_cast<uint64_t>(live) &&
+         !peak.compare_exchange_weak(old_peak, static_cast<uint64_t>(live),
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+void Publish(MemoryTag tag) {
+  int64_t bytes = std::exchange(tls_unpublished[tag], 0);
+  int64_t live = Registry::Get().published_bytes_[tag].fetch_add(
+                     bytes, std::memory_order_relaxed) +
+                 bytes;
+  RaisePeak(tag, live);
+}
+
+// Threads only touch the shared live bytes once their own change reaches
+// kPeakSlack, which bounds how much of a peak each of them can hide.
+void AddLive(MemoryTag tag, int64_t bytes) {
+  constexpr auto kSlack = static_cast<int64_t>(MemoryTracker::kPeakSlack);
+  int64_t unpublished = tls_unpublished[tag] += bytes;
+  if (unpublished >= kSlack || unpublished <= -kSlack || tls_exited) {
+    Publish(tag);
+  }
+}
+
+struct CountersOwner {
+  ~CountersOwner() {
+    for (size_t tag = 0; tag < MemoryTracker::kMaxTagCnt; ++tag) {
+      Publish(static_cast<MemoryTag>(tag));
+    }
+    tls_exited = true;
+    if (tls_counters != nullptr) {
+      Counters* counters = tls_counters;
+      // Frees by later thread_local destructors go to the shared counters.
+      tls_counters = &Registry::Get().retired_;
+      counters->retired_.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local CountersOwner tls_owner;
+
+Counters& GetCounters() {
+  if (tls_counters == nullptr) {
+    // Touch the owner so its destructor runs at thread exit.
+    static_cast<void>(&tls_owner);
+    Registry& registry = Registry::Get();
+    auto* counters = new Counters();
+    std::lock_guard<std::mutex> lock(registry.mutex_);
+    registry.threads_.push_back(counters);
+    tls_counters = counters;
+  }
+  return *tls_counters;
+}
+
+struct Header {
+  size_t size_;
+  MemoryTag tag_;
+};
+
+// Tag of blocks allocated by the tracker itself.
+constexpr MemoryTag kUntracked = UINT8_MAX;
+
+// Tags index fixed-size counter arrays.
+void CheckTag(MemoryTag tag) {
+  if (tag >= MemoryTracker::kMaxTagCnt) {
+    throw std::out_of_range("Memory tag is out of range.");
+  }
+}
+
+size_t HeaderSize(size_t align) {
+  return std::max(align, alignof(std::max_align_t));
+}
+
+// Straight from the C heap, operator new may lead back here.
+void* RawAllocate(size_t size, size_t align) {
+#if defined(_WIN32)
+  void* ptr = _aligned_malloc(size, align);
+#else
+  void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void RawFree(void* ptr) {
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+// The header keeps the size, so any block can be freed knowing only its
+// alignment.
+void Release(void* ptr, size_t align) {
+  if (ptr == nullptr) {
+    return;
+  }
+  std::byte* block = static_cast<std::byte*>(ptr) - HeaderSize(align);
+  auto* header = std::launder(reinterpret_cast<Header*>(block));
+  if (header->tag_ != kUntracked) {
+    MemoryTracker::OnDeallocate(header->tag_, header->size_);
+  }
+  RawFree(block);
+}
+
+}  // namespace
+
+MemoryTag MemoryTracker::RegisterTag(const char* name) {
+  Registry& registry = Registry::Get();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  if (registry.tag_cnt_ == kMaxTagCnt) {
+    throw std::out_of_range("Too many memory tags.");
+  }
+  registry.names_[registry.tag_cnt_] = name;
+  return static_cast<MemoryTag>(registry.tag_cnt_++);
+}
+
+size_t MemoryTracker::TagCnt() {
+  Registry& registry = Registry::Get();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  return registry.tag_cnt_;
+}
+
+MemoryTag MemoryTracker::CurrentTag() { return tls_tag; }
+
+MemoryTag MemoryTracker::SetCurrentTag(MemoryTag tag) {
+  CheckTag(tag);
+  return std::exchange(tls_tag, tag);
+}
+
+void MemoryTracker::OnAllocate(MemoryTag tag, size_t size) {
+  CheckTag(tag);
+  TrackingScope scope;
+  Counters& counters = GetCounters();
+  counters.alloc_cnt_[tag].fetch_add(1, std::memory_order_relaxed);
+  counters.alloc_bytes_[tag].fetch_add(size, std::memory_order_relaxed);
+  AddLive(tag, static_cast<int64_t>(size));
+}
+
+void MemoryTracker::OnDeallocate(MemoryTag tag, size_t size) {
+  CheckTag(tag);
+  TrackingScope scope;
+  Counters& counters = GetCounters();
+  counters.free_cnt_[tag].fetch_add(1, std::memory_order_relaxed);
+  counters.free_bytes_[tag].fetch_add(size, std::memory_order_relaxed);
+  AddLive(tag, -static_cast<int64_t>(size));
+}
+
+MemoryStats MemoryTracker::Stats(MemoryTag tag) {
+  Registry& registry = Registry::Get();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  if (tag >= registry.tag_cnt_) {
+    throw std::out_of_range("Memory tag is not registered.");
+  }
+  registry.Compact();
+  MemoryStats stats{};
+  stats.name_ = registry.names_[tag];
+  stats.alloc_cnt_ = registry.Sum(&Counters::alloc_cnt_, tag);
+  stats.free_cnt_ = registry.Sum(&Counters::free_cnt_, tag);
+  // Threads keep counting meanwhile, so a free may be seen before its
+  // allocation.
+  auto live = static_cast<int64_t>(registry.Sum(&Counters::alloc_bytes_, tag) -
+                                   registry.Sum(&Counters::free_bytes_, tag));
+  stats.live_bytes_ = static_cast<size_t>(std::max<int64_t>(live, 0));
+  RaisePeak(tag, live);
+  stats.peak_bytes_ = registry.peak_bytes_[tag].load(std::memory_order_relaxed);
+  return stats;
+}
+
+uint64_t MemoryTracker::AllocCnt() {
+  Registry& registry = Registry::Get();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  uint64_t cnt = 0;
+  for (size_t tag = 0; tag < registry.tag_cnt_; ++tag) {
+    cnt += registry.Sum(&Counters::alloc_cnt_, static_cast<MemoryTag>(tag));
+  }
+  return cnt;
+}
+
+std::string MemoryTracker::Dump() {
+  std::string out;
+  for (size_t tag = 0; tag < TagCnt(); ++tag) {
+    MemoryStats stats = Stats(static_cast<MemoryTag>(tag));
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "%-16s live %12zu peak %12zu allocs %10llu frees %10llu\n",
+                  stats.name_, stats.live_bytes_, stats.peak_bytes_,
+                  static_cast<unsigned long long>(stats.alloc_cnt_),
+                  static_cast<unsigned long long>(stats.free_cnt_));
+    out += line;
+  }
+  return out;
+}
+
+void* pigeon::TrackedAllocate(size_t size, size_t align) {
+  size_t header_size = HeaderSize(align);
+  auto* block =
+      static_cast<std::byte*>(RawAllocate(header_size + size, header_size));
+  MemoryTag tag = tls_tracking ? kUntracked : MemoryTracker::CurrentTag();
+  new (block) Header{size, tag};
+  if (tag != kUntracked) {
+    try {
+      MemoryTracker::OnAllocate(tag, size);
+    } catch (...) {
+      RawFree(block);
+      throw;
+    }
+  }
+  return block + header_size;
+}
+
+void pigeon::TrackedDeallocate(void* ptr, size_t, size_t align) {
+  Release(ptr, align);
+}
+
+#if defined(PIGEON_TRACK_MEMORY)
+// Plain new is counted as well, like Owned::New or the nodes of standard
+// containers. The array and nothrow forms call these by default. A Windows
+// DLL build only replaces them inside the DLL.
+void* operator new(size_t size) {
+  return TrackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+  return TrackedAllocate(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept {
+  Release(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  Release(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, std::align_val_t align) noexcept {
+  Release(ptr, static_cast<size_t>(align));
+}
+
+void operator delete(void* ptr, size_t,
+                     std::align_val_t align) noexcept {
+  Release(ptr, static_cast<size_t>(align));
+}
+#endif
@@ -0,0 +1,99 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_MEMORY_TRACKER
+#define PIGEON_FRAMEWORK_BASE_MEMORY_MEMORY_TRACKER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// Subsystem an allocation is charged to. Threads charge the tag of their
+// innermost MemoryTagScope, General outside of any.
+using MemoryTag = uint8_t;
+
+inline constexpr MemoryTag kMemoryTagGeneral = 0;
+inline constexpr MemoryTag kMemoryTagTasks = 1;
+inline constexpr MemoryTag kMemoryTagTimers = 2;
+
+struct MemoryStats {
+  const char* name_;
+  size_t live_bytes_;
+  // Highest live_bytes_ seen so far, which may miss up to
+  // MemoryTracker::kPeakSlack per thread of a short spike.
+  size_t peak_bytes_;
+  uint64_t alloc_cnt_;
+  uint64_t free_cnt_;
+};
+
+// Counts what HeapAllocator hands out: containers, Shared, Owned::NewIn and
+// the slabs of every SlabPool, charged to the pool's tag. Global operator new
+// and delete are replaced as well, so plain new is counted too.
+//
+// Each thread counts into its own slots, which are only summed up when stats
+// are read. The peak is checked on every read and whenever the live bytes of
+// a thread have moved by kPeakSlack since it last checked.
+//
+// Allocations are only counted when the framework is built with the
+// `track_memory` option; otherwise all stats stay zero.
+class PIGEON_API MemoryTracker {
+ public:
+  static constexpr size_t kMaxTagCnt = 32;
+  static constexpr size_t kPeakSlack = 64 * 1024;
+
+#if defined(PIGEON_TRACK_MEMORY)
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  // Returns a new tag, throws once kMaxTagCnt tags exist. `name` must
+  // outlive the tracker.
+  static MemoryTag RegisterTag(const char* name);
+
+  static size_t TagCnt();
+
+  static MemoryTag CurrentTag();
+
+  // These and MemoryTagScope throw for tags not below kMaxTagCnt.
+  static void OnAllocate(MemoryTag tag, size_t size);
+  static void OnDeallocate(MemoryTag tag, size_t size);
+
+  static MemoryStats Stats(MemoryTag tag);
+
+  // Allocations of all tags so far. Comparing two readings tells whether
+  // anything allocated in between.
+  static uint64_t AllocCnt();
+
+  // One line per tag.
+  static std::string Dump();
+
+ private:
+  friend class MemoryTagScope;
+
+  static MemoryTag SetCurrentTag(MemoryTag tag);
+};
+
+class MemoryTagScope {
+ public:
+  explicit MemoryTagScope(MemoryTag tag)
+      : outer_(MemoryTracker::SetCurrentTag(tag)) {}
+
+  MemoryTagScope(const MemoryTagScope& other) = delete;
+  MemoryTagScope& operator=(const MemoryTagScope& other) = delete;
+
+  ~MemoryTagScope() { MemoryTracker::SetCurrentTag(outer_); }
+
+ private:
+  MemoryTag outer_;
+};
+
+// Heap allocation recorded under the current tag. A small header in front of
+// the block remembers the tag and size for the matching deallocation. Both
+// bypass operator new, which calls them when tracking.
+PIGEON_API void* TrackedAllocate(size_t size, size_t align);
+PIGEON_API void TrackedDeallocate(void* ptr, size_t size, size_t align);
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_MEMORY_TRACKER
@@ -0,0 +1,53 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_OBJECT_POOL
+#define PIGEON_FRAMEWORK_BASE_MEMORY_OBJECT_POOL
+
+#include <cstddef>
+#include <utility>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/auto_ptr/shared.hpp"
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+#include "pigeon_framework/base/memory/slab_pool.hpp"
+
+namespace pigeon {
+
+// Typed front of a SlabPool for small objects created and destroyed at a high
+// rate, like events or components. Owned and Shared made by the pool carry a
+// PoolAllocator, so dropping them on any thread returns the memory to the
+// pool. Pools are cheap handles; all pools of one tag share their slabs.
+template <typename T>
+class ObjectPool {
+ public:
+  using Deleter = AllocatorDelete<T, PoolAllocator>;
+  using OwnedType = Owned<T, Deleter>;
+
+  ObjectPool() = default;
+
+  explicit ObjectPool(MemoryTag tag) : allocator_(&SlabPool::Get(tag)) {}
+
+  template <typename... Args>
+  OwnedType New(Args&&... args) const {
+    return Owned<T>::NewIn(allocator_, std::forward<Args>(args)...);
+  }
+
+  // The object shares its block with the counters, see Shared::NewIn.
+  template <AsRefCount R = ThreadSafeRefCount, typename... Args>
+  Shared<T, R> NewShared(Args&&... args) const {
+    return Shared<T, R>::NewIn(allocator_, std::forward<Args>(args)...);
+  }
+
+  // Makes sure `cnt` objects can be made by New without going to the heap.
+  void Reserve(size_t cnt) const {
+    if (alignof(T) <= SlabPool::kBlockAlign) {
+      allocator_.Pool()->Reserve(sizeof(T), cnt);
+    }
+  }
+
+  PoolAllocator GetAllocator() const { return allocator_; }
+
+ private:
+  PoolAllocator allocator_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_OBJECT_POOL
@@ -0,0 +1,69 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_RELOCATE
+#define PIGEON_FRAMEWORK_BASE_MEMORY_RELOCATE
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pigeon {
+
+// Relocation moves an object to a new address and ends the lifetime of the
+// source. Specialize this for types whose bytes can simply be copied, e.g.
+// handles that own a resource but never point into themselves.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool kTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+// Relocate `count` objects from `src` into the uninitialized `dst`. The ranges
+// must not overlap.
+template <typename T>
+void RelocateRange(T* src, size_t count, T* dst) {
+  if (count == 0) {
+    return;
+  }
+  if constexpr (kTriviallyRelocatable<T>) {
+    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src),
+                count * sizeof(T));
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      new (dst + i) T(std::move(src[i]));
+      src[i].~T();
+    }
+  }
+}
+
+// Same as RelocateRange, but the ranges may overlap, as when shifting elements
+// inside one buffer.
+template <typename T>
+void RelocateOverlapping(T* src, size_t count, T* dst) {
+  if (count == 0 || src == dst) {
+    return;
+  }
+  if constexpr (kTriviallyRelocatable<T>) {
+    std::memmove(static_cast<void*>(dst), static_cast<const void*>(src),
+                 count * sizeof(T));
+  } else if (dst < src) {
+    RelocateRange(src, count, dst);
+  } else {
+    for (size_t i = count; i > 0; --i) {
+      new (dst + i - 1) T(std::move(src[i - 1]));
+      src[i - 1].~T();
+    }
+  }
+}
+
+template <typename T>
+void DestroyRange(T* data, size_t count) {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    for (size_t i = 0; i < count; ++i) {
+      data[i].~T();
+    }
+  }
+}
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_RELOCATE
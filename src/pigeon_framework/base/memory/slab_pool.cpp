@@ -0,0 +1,251 @@
+#include "pigeon_framework/base/memory/slab_pool.hpp"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+using namespace pigeon;
+
+namespace {
+
+constexpr size_t kClassCnt = SlabPool::kMaxBlockSize / SlabPool::kGranularity;
+constexpr size_t kMaxCached = 256;
+constexpr size_t kRefillCnt = 64;
+
+struct Block {
+  Block* next_;
+};
+
+struct FreeList {
+  Block* head_{nullptr};
+  size_t cnt_{0};
+
+  void Push(void* ptr) {
+    auto* block = static_cast<Block*>(ptr);
+    block->next_ = head_;
+    head_ = block;
+    ++cnt_;
+  }
+
+  void* Pop() {
+    Block* block = head_;
+    head_ = block->next_;
+    --cnt_;
+    return block;
+  }
+
+  // Move up to `cnt` blocks from the front of this list to `other`.
+  void MoveTo(FreeList& other, size_t cnt) {
+    while (cnt > 0 && head_ != nullptr) {
+      other.Push(Pop());
+      --cnt;
+    }
+  }
+
+  // Move all but the first `keep` blocks to `other`. The front holds the
+  // most recently freed blocks, which are likely still in cache.
+  void MoveTailTo(FreeList& other, size_t keep) {
+    if (cnt_ <= keep) {
+      return;
+    }
+    FreeList tail;
+    if (keep == 0) {
+      tail = std::exchange(*this, FreeList());
+    } else {
+      Block* last = head_;
+      for (size_t i = 1; i < keep; ++i) {
+        last = last->next_;
+      }
+      tail.head_ = std::exchange(last->next_, nullptr);
+      tail.cnt_ = cnt_ - keep;
+      cnt_ = keep;
+    }
+    tail.MoveTo(other, tail.cnt_);
+  }
+};
+
+size_t ClassOf(size_t size) {
+  return size == 0 ? 0 : (size - 1) / SlabPool::kGranularity;
+}
+
+size_t BlockSizeOf(size_t cls) { return (cls + 1) * SlabPool::kGranularity; }
+
+}  // namespace
+
+struct SlabPool::Depot {
+  std::mutex mutex_;
+  FreeList lists_[kClassCnt];
+  std::atomic_size_t slab_cnt_{0};
+
+  // Hand out cached blocks, or carve a new slab when there are none. Only a
+  // batch of a new slab goes to the thread, the rest stays in the depot.
+  void Refill(FreeList& list, size_t cls, MemoryTag tag) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lists_[cls].MoveTo(list, kRefillCnt);
+    }
+    if (list.head_ != nullptr) {
+      return;
+    }
+    Carve(list, cls, tag);
+    std::lock_guard<std::mutex> lock(mutex_);
+    list.MoveTailTo(lists_[cls], kRefillCnt);
+  }
+
+  void Carve(FreeList& list, size_t cls, MemoryTag tag) {
+    size_t block_size = BlockSizeOf(cls);
+    MemoryTagScope scope(tag);
+    auto* slab = static_cast<std::byte*>(
+        HeapAllocator().Allocate(SlabPool::kSlabSize, SlabPool::kBlockAlign));
+    slab_cnt_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t offset = 0; offset + block_size <= SlabPool::kSlabSize;
+         offset += block_size) {
+      list.Push(slab + offset);
+    }
+  }
+
+  void Drain(FreeList& list, size_t cls, size_t keep) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list.MoveTailTo(lists_[cls], keep);
+  }
+
+  size_t CachedCnt(size_t cls) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lists_[cls].cnt_;
+  }
+};
+
+namespace {
+
+struct ThreadCache {
+  SlabPool::Depot* depot_;
+  FreeList lists_[kClassCnt];
+};
+
+thread_local bool tls_caches_destroyed = false;
+
+// Caches of the pools this thread has used, indexed by tag.
+struct ThreadCaches {
+  ThreadCache* caches_[MemoryTracker::kMaxTagCnt]{};
+
+  ~ThreadCaches() {
+    tls_caches_destroyed = true;
+    for (ThreadCache* cache : caches_) {
+      if (cache == nullptr) {
+        continue;
+      }
+      for (size_t cls = 0; cls < kClassCnt; ++cls) {
+        cache->depot_->Drain(cache->lists_[cls], cls, 0);
+      }
+      delete cache;
+    }
+  }
+};
+
+thread_local ThreadCaches tls_caches;
+
+// Null once this thread's caches are gone, e.g. for blocks freed by other
+// thread_local destructors. Those go through the depot directly.
+ThreadCache* GetCache(MemoryTag tag, SlabPool::Depot* depot) {
+  if (tls_caches_destroyed) {
+    return nullptr;
+  }
+  ThreadCache*& cache = tls_caches.caches_[tag];
+  if (cache == nullptr) {
+    cache = new ThreadCache{depot};
+  }
+  return cache;
+}
+
+struct Registry {
+  std::mutex mutex_;
+  std::atomic<SlabPool*> pools_[MemoryTracker::kMaxTagCnt]{};
+
+  static Registry& Get() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+};
+
+}  // namespace
+
+SlabPool& SlabPool::Get(MemoryTag tag) {
+  if (tag >= MemoryTracker::kMaxTagCnt) {
+    throw std::out_of_range("Memory tag is not registered.");
+  }
+  Registry& registry = Registry::Get();
+  SlabPool* pool = registry.pools_[tag].load(std::memory_order_acquire);
+  if (pool != nullptr) {
+    return *pool;
+  }
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  pool = registry.pools_[tag].load(std::memory_order_relaxed);
+  if (pool == nullptr) {
+    pool = new SlabPool(tag);
+    registry.pools_[tag].store(pool, std::memory_order_release);
+  }
+  return *pool;
+}
+
+SlabPool::SlabPool(MemoryTag tag) : tag_(tag), depot_(new Depot()) {}
+
+void* SlabPool::Allocate(size_t size) {
+  if (size > kMaxBlockSize) {
+    MemoryTagScope scope(tag_);
+    return HeapAllocator().Allocate(size, kBlockAlign);
+  }
+  size_t cls = ClassOf(size);
+  ThreadCache* cache = GetCache(tag_, depot_);
+  if (cache == nullptr) {
+    FreeList list;
+    depot_->Refill(list, cls, tag_);
+    void* ptr = list.Pop();
+    depot_->Drain(list, cls, 0);
+    return ptr;
+  }
+  FreeList& list = cache->lists_[cls];
+  if (list.head_ == nullptr) {
+    depot_->Refill(list, cls, tag_);
+  }
+  return list.Pop();
+}
+
+void SlabPool::Deallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > kMaxBlockSize) {
+    HeapAllocator().Deallocate(ptr, size, kBlockAlign);
+    return;
+  }
+  size_t cls = ClassOf(size);
+  ThreadCache* cache = GetCache(tag_, depot_);
+  if (cache == nullptr) {
+    FreeList list;
+    list.Push(ptr);
+    depot_->Drain(list, cls, 0);
+    return;
+  }
+  FreeList& list = cache->lists_[cls];
+  list.Push(ptr);
+  if (list.cnt_ > kMaxCached) {
+    depot_->Drain(list, cls, kMaxCached / 2);
+  }
+}
+
+void SlabPool::Reserve(size_t size, size_t cnt) {
+  if (size > kMaxBlockSize) {
+    return;
+  }
+  size_t cls = ClassOf(size);
+  FreeList list;
+  size_t cached_cnt = depot_->CachedCnt(cls);
+  while (cached_cnt + list.cnt_ < cnt) {
+    depot_->Carve(list, cls, tag_);
+  }
+  depot_->Drain(list, cls, 0);
+}
+
+size_t SlabPool::SlabCnt() const {
+  return depot_->slab_cnt_.load(std::memory_order_relaxed);
+}
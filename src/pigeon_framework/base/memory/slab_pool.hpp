@@ -0,0 +1,88 @@
+#ifndef PIGEON_FRAMEWORK_BASE_MEMORY_SLAB_POOL
+#define PIGEON_FRAMEWORK_BASE_MEMORY_SLAB_POOL
+
+#include <cstddef>
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// Size-class slab allocator for small objects, one per memory tag. Each thread
+// keeps a free list per size class, so once the slabs are warm allocating and
+// freeing don't touch the global heap or take a lock. A block freed on another
+// thread simply joins that thread's list; overflowing lists spill into a
+// shared depot the other threads refill from. Slabs are charged to the pool's
+// tag and never returned to the heap, which keeps long-running processes from
+// fragmenting it.
+class PIGEON_API SlabPool {
+ public:
+  static constexpr size_t kGranularity = 16;
+  static constexpr size_t kMaxBlockSize = 512;
+  static constexpr size_t kSlabSize = 64 * 1024;
+  static constexpr size_t kBlockAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  // Created on first use and never destroyed, blocks may be freed during
+  // static destruction.
+  static SlabPool& Get(MemoryTag tag);
+
+  SlabPool(const SlabPool& other) = delete;
+  SlabPool& operator=(const SlabPool& other) = delete;
+
+  // Blocks are aligned to kBlockAlign. Sizes above kMaxBlockSize go straight
+  // to the heap.
+  void* Allocate(size_t size);
+  void Deallocate(void* ptr, size_t size);
+
+  // Carves slabs up front until the depot holds `cnt` blocks of `size`, so
+  // that a burst of allocations doesn't hit the heap.
+  void Reserve(size_t size, size_t cnt);
+
+  // Number of slabs carved so far, to check for steady state.
+  size_t SlabCnt() const;
+
+  MemoryTag Tag() const { return tag_; }
+
+  // Shared free lists, defined in slab_pool.cpp.
+  struct Depot;
+
+ private:
+  explicit SlabPool(MemoryTag tag);
+
+  MemoryTag tag_;
+  Depot* depot_;
+};
+
+// Allocator handle over a SlabPool. Over-aligned blocks come from the heap.
+class PoolAllocator {
+ public:
+  PoolAllocator() : pool_(&SlabPool::Get(kMemoryTagGeneral)) {}
+
+  PoolAllocator(SlabPool* pool) : pool_(pool) {}
+
+  void* Allocate(size_t size, size_t align) {
+    if (align > SlabPool::kBlockAlign) {
+      return HeapAllocator().Allocate(size, align);
+    }
+    return pool_->Allocate(size);
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t align) {
+    if (align > SlabPool::kBlockAlign) {
+      HeapAllocator().Deallocate(ptr, size, align);
+      return;
+    }
+    pool_->Deallocate(ptr, size);
+  }
+
+  SlabPool* Pool() const { return pool_; }
+
+  bool operator==(const PoolAllocator&) const = default;
+
+ private:
+  SlabPool* pool_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_BASE_MEMORY_SLAB_POOL
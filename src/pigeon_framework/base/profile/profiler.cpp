@@ -0,0 +1,176 @@
+#include "pigeon_framework/base/profile/profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/ring_buffer.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+struct ThreadRing {
+  explicit ThreadRing(uint32_t thread_id)
+      : events_(Profiler::kRingCapacity), thread_id_(thread_id) {}
+
+  SpscRingBuffer<ProfileEvent> events_;
+  uint32_t thread_id_;
+  std::atomic_size_t dropped_cnt_{0};
+  // Set when the thread exits, the ring goes away once drained.
+  std::atomic_bool retired_{false};
+};
+
+// Never destroyed, threads may still record during static destruction.
+struct Registry {
+  std::mutex mutex_;
+  Array<Owned<ThreadRing>> rings_;
+  uint32_t next_thread_id_{0};
+  size_t retired_dropped_cnt_{0};
+  std::atomic_bool enabled_{true};
+  std::chrono::steady_clock::time_point epoch_{
+      std::chrono::steady_clock::now()};
+
+  static Registry& Get() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+};
+
+struct RingHolder {
+  ~RingHolder() {
+    if (ring_ != nullptr) {
+      ring_->retired_.store(true, std::memory_order_release);
+    }
+  }
+
+  ThreadRing* ring_{nullptr};
+};
+
+thread_local RingHolder tls_ring;
+
+ThreadRing* CurrentRing() {
+  if (tls_ring.ring_ == nullptr) {
+    Registry& registry = Registry::Get();
+    std::lock_guard<std::mutex> lock(registry.mutex_);
+    auto ring = Owned<ThreadRing>::New(registry.next_thread_id_++);
+    tls_ring.ring_ = ring.Get();
+    registry.rings_.EmplaceBack(std::move(ring));
+  }
+  return tls_ring.ring_;
+}
+
+void AppendEscaped(std::string& out, const char* str) {
+  for (; *str != '\0'; ++str) {
+    char c = *str;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+}
+
+void AppendMicros(std::string& out, uint64_t ns) {
+  char micros[32];
+  std::snprintf(micros, sizeof(micros), "%llu.%03llu",
+                static_cast<unsigned long long>(ns / 1000),
+                static_cast<unsigned long long>(ns % 1000));
+  out += micros;
+}
+
+}  // namespace
+
+void Profiler::SetEnabled(bool enabled) {
+  Registry::Get().enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsEnabled() {
+  return Registry::Get().enabled_.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - Registry::Get().epoch_)
+      .count();
+}
+
+void Profiler::Record(const char* name, uint64_t begin_ns, uint64_t end_ns) {
+  if (!IsEnabled()) {
+    return;
+  }
+  ThreadRing* ring = CurrentRing();
+  if (!ring->events_.TryPush(
+          ProfileEvent{name, begin_ns, end_ns, ring->thread_id_})) {
+    ring->dropped_cnt_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+Array<ProfileEvent> Profiler::Collect() {
+  Array<ProfileEvent> events;
+  Registry& registry = Registry::Get();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex_);
+    auto push = [&events](ProfileEvent&& event) { events.PushBack(event); };
+    registry.rings_.EraseIf([&](Owned<ThreadRing>& ring) {
+      // Read before draining, so nothing recorded before exit is missed.
+      bool retired = ring->retired_.load(std::memory_order_acquire);
+      ring->events_.PopBatch(push);
+      if (retired) {
+        registry.retired_dropped_cnt_ += ring->dropped_cnt_;
+      }
+      return retired;
+    });
+  }
+  std::sort(events.begin(), events.end(),
+            [](const ProfileEvent& lhs, const ProfileEvent& rhs) {
+              return lhs.begin_ns_ < rhs.begin_ns_;
+            });
+  return events;
+}
+
+size_t Profiler::DroppedCnt() {
+  Registry& registry = Registry::Get();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  size_t cnt = registry.retired_dropped_cnt_;
+  for (Owned<ThreadRing>& ring : registry.rings_) {
+    cnt += ring->dropped_cnt_.load(std::memory_order_relaxed);
+  }
+  return cnt;
+}
+
+std::string Profiler::ToChromeTrace(const Array<ProfileEvent>& events) {
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (size_t i = 0; i < events.Size(); ++i) {
+    const ProfileEvent& event = events[i];
+    out += i == 0 ? "\n" : ",\n";
+    out += "{\"ph\":\"X\",\"pid\":0,\"tid\":";
+    out += std::to_string(event.thread_id_);
+    out += ",\"name\":\"";
+    AppendEscaped(out, event.name_);
+    out += "\",\"ts\":";
+    AppendMicros(out, event.begin_ns_);
+    out += ",\"dur\":";
+    AppendMicros(out, event.end_ns_ - event.begin_ns_);
+    out += "}";
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+bool Profiler::WriteChromeTrace(const char* path) {
+  std::string trace = ToChromeTrace(Collect());
+  std::FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool written = std::fwrite(trace.data(), 1, trace.size(), file) ==
+                 trace.size();
+  return std::fclose(file) == 0 && written;
+}
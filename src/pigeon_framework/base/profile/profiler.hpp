@@ -0,0 +1,82 @@
+#ifndef PIGEON_FRAMEWORK_BASE_PROFILE_PROFILER
+#define PIGEON_FRAMEWORK_BASE_PROFILE_PROFILER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// A finished zone. Names must outlive the profiler, e.g. string literals.
+struct ProfileEvent {
+  const char* name_;
+  uint64_t begin_ns_;
+  uint64_t end_ns_;
+  uint32_t thread_id_;
+};
+
+// Collects zones recorded on any thread. Each thread writes into its own
+// lock-free ring buffer and never blocks; when the ring is full the event is
+// dropped and counted. Collect drains all rings from one thread at a time.
+//
+// The PIGEON_PROFILE_* macros below only record when the framework is built
+// with the `profile` option, and otherwise compile to nothing.
+class PIGEON_API Profiler {
+ public:
+  static constexpr size_t kRingCapacity = 16 * 1024;
+
+  // Pauses or resumes recording, on by default.
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  // Nanoseconds since the profiler started.
+  static uint64_t Now();
+
+  static void Record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+  // Takes every event recorded so far, ordered by begin time.
+  static Array<ProfileEvent> Collect();
+
+  // Events lost to full rings so far.
+  static size_t DroppedCnt();
+
+  // Chrome Trace Event JSON, which Perfetto and chrome://tracing open.
+  static std::string ToChromeTrace(const Array<ProfileEvent>& events);
+
+  // Collects and writes a Chrome trace to `path`, false if it can't be
+  // written.
+  static bool WriteChromeTrace(const char* path);
+};
+
+// Records the time from construction to destruction under `name`.
+class ProfileZone {
+ public:
+  explicit ProfileZone(const char* name)
+      : name_(name), begin_ns_(Profiler::Now()) {}
+
+  ProfileZone(const ProfileZone& other) = delete;
+  ProfileZone& operator=(const ProfileZone& other) = delete;
+
+  ~ProfileZone() { Profiler::Record(name_, begin_ns_, Profiler::Now()); }
+
+ private:
+  const char* name_;
+  uint64_t begin_ns_;
+};
+
+}  // namespace pigeon
+
+#define PIGEON_PROFILE_CONCAT_INNER(a, b) a##b
+#define PIGEON_PROFILE_CONCAT(a, b) PIGEON_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PIGEON_PROFILE)
+#define PIGEON_PROFILE_ZONE(name)                                 \
+  ::pigeon::ProfileZone PIGEON_PROFILE_CONCAT(pigeon_profile_zone_, \
+                                              __LINE__)(name)
+#else
+#define PIGEON_PROFILE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif  // PIGEON_FRAMEWORK_BASE_PROFILE_PROFILER
@@ -0,0 +1,52 @@
+#include "pigeon_framework/task/co_task.hpp"
+
+using namespace pigeon;
+
+Task::Status CoTask::Execute() {
+  while (!IsDone()) {
+    if (Status status = Poll(); status != Status::Done) {
+      return status;
+    }
+    promise_type& promise = handle_.promise();
+    promise.wait_ = promise_type::Wait::None;
+    handle_.resume();
+    if (promise.exception_) {
+      std::rethrow_exception(std::exchange(promise.exception_, nullptr));
+    }
+    // Anything else may already be ready, so keep going in this Execute.
+    if (promise.wait_ == promise_type::Wait::Frame) {
+      return Status::Keep;
+    } else if (promise.wait_ == promise_type::Wait::Park) {
+      return Status::Park;
+    }
+  }
+  return Status::Done;
+}
+
+// Done once the coroutine may resume, otherwise what to return meanwhile.
+Task::Status CoTask::Poll() {
+  promise_type& promise = handle_.promise();
+  switch (promise.wait_) {
+    case promise_type::Wait::Timer: {
+      if (Clock::now() >= promise.deadline_) {
+        return Status::Done;
+      }
+      TimerWheel* wheel = TimerWheel::Current();
+      Waker waker = wheel == nullptr ? Waker() : Waker::Current();
+      if (waker.IsNull()) {
+        return Status::Keep;
+      }
+      wheel->PostWakeAt(promise.deadline_, std::move(waker));
+      return Status::Park;
+    }
+    case promise_type::Wait::Task: {
+      Status status = promise.awaited_->Execute();
+      if (status == Status::Done) {
+        promise.awaited_ = Owned<Task>();
+      }
+      return status;
+    }
+    default:
+      return Status::Done;
+  }
+}
@@ -0,0 +1,146 @@
+#ifndef PIGEON_FRAMEWORK_TASK_CO_TASK
+#define PIGEON_FRAMEWORK_TASK_CO_TASK
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/task_arena.hpp"
+#include "pigeon_framework/task/timer_wheel.hpp"
+
+namespace pigeon {
+
+// Task written as a coroutine, which suspends with co_await instead of
+// returning Keep. It runs on any executor like other tasks:
+//
+//   CoTask Spawn(Level* level) {
+//     co_await CoTask::NextFrame();
+//     co_await CoTask::WaitFor(std::chrono::seconds(1));
+//     co_await LoadWave(level);  // Another CoTask, or any Owned<Task>.
+//     level->OnCleared(Waker::Current());
+//     co_await CoTask::Park();
+//   }
+//
+// Execute only resumes the coroutine once what it waits for is ready. A task
+// it waits for is executed in its place, and parks the coroutine when it
+// parks. Timed waits park until TimerWheel::Current() wakes the coroutine;
+// without a wheel or an executor that can park, they are checked every
+// Execute. Frames come from TaskArena.
+class PIGEON_API CoTask : public Task {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct NextFrame {};
+
+  // Suspends until the Waker taken before is woken.
+  struct Park {};
+
+  struct Timer {
+    Clock::time_point deadline_;
+  };
+
+  static Timer WaitUntil(Clock::time_point deadline) { return {deadline}; }
+
+  static Timer WaitFor(Clock::duration duration) {
+    return {Clock::now() + duration};
+  }
+
+  class promise_type {
+   public:
+    enum class Wait { None, Frame, Park, Timer, Task };
+
+    static void* operator new(size_t size) { return TaskArena::Allocate(size); }
+
+    static void operator delete(void* ptr, size_t size) {
+      TaskArena::Deallocate(ptr, size);
+    }
+
+    CoTask get_return_object() {
+      return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    // Starts on the first Execute rather than on creation.
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+
+    void return_void() {}
+
+    void unhandled_exception() { exception_ = std::current_exception(); }
+
+    std::suspend_always await_transform(NextFrame) {
+      wait_ = Wait::Frame;
+      return {};
+    }
+
+    std::suspend_always await_transform(Park) {
+      wait_ = Wait::Park;
+      return {};
+    }
+
+    std::suspend_always await_transform(Timer timer) {
+      wait_ = Wait::Timer;
+      deadline_ = timer.deadline_;
+      return {};
+    }
+
+    std::suspend_always await_transform(Owned<Task>&& task) {
+      wait_ = Wait::Task;
+      awaited_ = std::move(task);
+      return {};
+    }
+
+    std::suspend_always await_transform(CoTask&& task) {
+      return await_transform(Owned<Task>(Owned<CoTask>::New(std::move(task))));
+    }
+
+   private:
+    friend class CoTask;
+
+    Wait wait_{Wait::None};
+    Clock::time_point deadline_;
+    Owned<Task> awaited_;
+    std::exception_ptr exception_;
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  CoTask(const CoTask& other) = delete;
+
+  CoTask(CoTask&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  CoTask& operator=(const CoTask& other) = delete;
+
+  CoTask& operator=(CoTask&& other) noexcept {
+    if (this != &other) {
+      this->~CoTask();
+      ::new (this) CoTask(std::move(other));
+    }
+    return *this;
+  }
+
+  ~CoTask() override {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Rethrows what escaped the coroutine.
+  Status Execute() override;
+
+  bool IsDone() const { return !handle_ || handle_.done(); }
+
+ private:
+  explicit CoTask(Handle handle) : handle_(handle) {}
+
+  Status Poll();
+
+  Handle handle_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_CO_TASK
@@ -0,0 +1,29 @@
+#include "pigeon_framework/task/parallel_tasks.hpp"
+
+using namespace pigeon;
+
+ParallelTasks::ParallelTasks(size_t thread_cnt) : pool_(thread_cnt) {}
+
+void ParallelTasks::Push(Owned<Task>&& task) {
+  tasks_.EmplaceBack(std::move(task));
+}
+
+Task::Status ParallelTasks::Execute() {
+  wake_queue_.TakeWoken(tasks_);
+  size_t size = tasks_.Size();
+  if (size == 0) {
+    return wake_queue_.Idle();
+  }
+  status_.Resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    pool_.Seed(i);
+  }
+  pool_.Run(size, [this](size_t index, size_t) {
+    status_[index] = wake_queue_.Execute(tasks_[index]);
+  });
+
+  size_t index = 0;
+  tasks_.EraseIf(
+      [this, &index](Owned<Task>&) { return status_[index++] != Keep; });
+  return tasks_.IsEmpty() ? wake_queue_.Idle() : Status::Keep;
+}
@@ -0,0 +1,43 @@
+#ifndef PIGEON_FRAMEWORK_TASK_PARALLEL_TASKS
+#define PIGEON_FRAMEWORK_TASK_PARALLEL_TASKS
+
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/waker.hpp"
+#include "pigeon_framework/task/worker_pool.hpp"
+
+namespace pigeon {
+
+template class PIGEON_API Array<Owned<Task>>;
+
+// Runs every task once per Execute on a WorkerPool, and returns when all of
+// them have finished. Tasks returning Keep run again on the next Execute, like
+// in SerialTasks, and parked tasks come back once woken.
+class PIGEON_API ParallelTasks : public Task {
+ public:
+  explicit ParallelTasks(size_t thread_cnt = WorkerPool::DefaultThreadCnt());
+  ~ParallelTasks() override = default;
+
+  // Not thread-safe, and not allowed while Execute is running.
+  void Push(Owned<Task>&& task);
+
+  Status Execute() override;
+
+  size_t Size() const { return tasks_.Size(); }
+
+  size_t ParkedCnt() const { return wake_queue_.ParkedCnt(); }
+
+  size_t ThreadCnt() const { return pool_.ThreadCnt(); }
+
+ private:
+  Array<Owned<Task>> tasks_;
+  Array<Status> status_;
+  WakeQueue wake_queue_;
+  WorkerPool pool_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_PARALLEL_TASKS
@@ -2,15 +2,14 @@
 
 using namespace pigeon;
 
+void SerialTasks::Push(Owned<Task>&& task) {
+  tasks_.EmplaceBack(std::move(task));
+}
+
 Task::Status SerialTasks::Execute() {
-  size_t size = tasks_.Size();
-  size_t tail(0);
-  for (size_t i = 0; i < size; ++i) {
-    if (tasks_[i]->Execute() == Status::Keep) {
-      tasks_.Swap(i, tail);
-      ++tail;
-    }
-  }
-  tasks_.Resize(tail);
-  return tail == 0 ? Status::Done : Status::Keep;
+  wake_queue_.TakeWoken(tasks_);
+  tasks_.RetainIf([this](Owned<Task>& task) {
+    return wake_queue_.Execute(task) == Status::Keep;
+  });
+  return tasks_.IsEmpty() ? wake_queue_.Idle() : Status::Keep;
 }
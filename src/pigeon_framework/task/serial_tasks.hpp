@@ -5,22 +5,31 @@
 #include "pigeon_framework/base/container/array.hpp"
 #include "pigeon_framework/define.hpp"
 #include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/waker.hpp"
 
 INSTANTIATE_OWNED(pigeon::Task);
 
 namespace pigeon {
 
-template class PIGEON_API Array<Owned<Task>>;
+template class PIGEON_API Array<Owned<Task>, HeapAllocator, 8>;
 
 class PIGEON_API SerialTasks : public Task {
  public:
   SerialTasks() = default;
   ~SerialTasks() override = default;
 
+  void Push(Owned<Task>&& task);
+
   Status Execute() override;
 
+  // Runnable tasks only, parked ones are not touched until woken.
+  size_t Size() const { return tasks_.Size(); }
+
+  size_t ParkedCnt() const { return wake_queue_.ParkedCnt(); }
+
  private:
-  Array<Owned<Task>> tasks_;
+  InlineArray<Owned<Task>, 8> tasks_;
+  WakeQueue wake_queue_;
 };
 
 }  // namespace pigeon
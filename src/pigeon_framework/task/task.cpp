@@ -0,0 +1,54 @@
+#include "pigeon_framework/task/task.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <typeinfo>
+#include "pigeon_framework/base/container/hash_map.hpp"
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+using namespace pigeon;
+
+namespace {
+
+// Demangled names are made once per type and never freed.
+const char* Demangle(const char* mangled) {
+#if defined(__GNUG__)
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+  if (status == 0) {
+    return demangled;
+  }
+  std::free(demangled);
+#endif
+  return mangled;
+}
+
+}  // namespace
+
+const char* Task::Name() const {
+  // Most lookups hit the thread's cache and skip the lock.
+  thread_local HashMap<std::string_view, const char*> cache;
+  static std::mutex mutex;
+  static auto* names = new HashMap<std::string_view, const char*>();
+
+  const char* mangled = typeid(*this).name();
+  auto it = cache.Find(mangled);
+  if (it != cache.end()) {
+    return it->value_;
+  }
+  const char* name;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [found, inserted] = names->Emplace(mangled, nullptr);
+    if (inserted) {
+      found->value_ = Demangle(mangled);
+    }
+    name = found->value_;
+  }
+  cache.Insert(mangled, name);
+  return name;
+}
@@ -2,16 +2,38 @@
 #define PIGEON_FRAMEWORK_TASK_TASK
 
 #include <concepts>
+#include <cstddef>
+#include <new>
+#include "pigeon_framework/base/container/mpsc_queue.hpp"
 #include "pigeon_framework/define.hpp"
 
 namespace pigeon {
 
-class PIGEON_API Task {
+// The MpscNode base lets a TaskInbox queue tasks without allocating.
+class PIGEON_API Task : public MpscNode {
  public:
-  enum Status { Keep, Done };
+  // Keep runs the task again on the next tick, Done retires it. Park takes it
+  // off the executor until a Waker wakes it, see waker.hpp.
+  enum Status { Keep, Done, Park };
 
   virtual ~Task() = default;
   virtual Status Execute() = 0;
+
+  // Label in profiles, the demangled type name unless overridden. Must stay
+  // valid for the lifetime of the program.
+  virtual const char* Name() const;
+
+  // Tasks are allocated from TaskArena, see task_arena.hpp.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
+  static void* operator new(size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+  }
+
+  static void operator delete(void* ptr, size_t size, std::align_val_t align) {
+    ::operator delete(ptr, size, align);
+  }
 };
 
 template <typename T>
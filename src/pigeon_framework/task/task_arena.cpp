@@ -0,0 +1,27 @@
+#include "pigeon_framework/task/task_arena.hpp"
+#include "pigeon_framework/task/task.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+SlabPool& GetPool() {
+  static SlabPool& pool = SlabPool::Get(kMemoryTagTasks);
+  return pool;
+}
+
+}  // namespace
+
+void* TaskArena::Allocate(size_t size) { return GetPool().Allocate(size); }
+
+void TaskArena::Deallocate(void* ptr, size_t size) {
+  GetPool().Deallocate(ptr, size);
+}
+
+size_t TaskArena::SlabCnt() { return GetPool().SlabCnt(); }
+
+void* Task::operator new(size_t size) { return TaskArena::Allocate(size); }
+
+void Task::operator delete(void* ptr, size_t size) {
+  TaskArena::Deallocate(ptr, size);
+}
@@ -0,0 +1,29 @@
+#ifndef PIGEON_FRAMEWORK_TASK_TASK_ARENA
+#define PIGEON_FRAMEWORK_TASK_TASK_ARENA
+
+#include <cstddef>
+#include "pigeon_framework/base/memory/slab_pool.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+// Allocator behind Task::operator new/delete and coroutine frames, the
+// SlabPool of the Tasks memory tag. Creating and retiring tasks doesn't touch
+// the global heap once its slabs are warm.
+class PIGEON_API TaskArena {
+ public:
+  static constexpr size_t kGranularity = SlabPool::kGranularity;
+  static constexpr size_t kMaxBlockSize = SlabPool::kMaxBlockSize;
+  static constexpr size_t kSlabSize = SlabPool::kSlabSize;
+
+  // Sizes above kMaxBlockSize go straight to the heap.
+  static void* Allocate(size_t size);
+  static void Deallocate(void* ptr, size_t size);
+
+  // Number of slabs carved so far, to check for steady state.
+  static size_t SlabCnt();
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_TASK_ARENA
@@ -0,0 +1,116 @@
+#include "pigeon_framework/task/task_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include "pigeon_framework/base/profile/profiler.hpp"
+
+using namespace pigeon;
+
+TaskGraph::TaskGraph(size_t thread_cnt) : pool_(thread_cnt) {}
+
+TaskGraph::NodeId TaskGraph::Add(Owned<Task>&& task,
+                                 std::span<const NodeId> predecessors) {
+  NodeId id = nodes_.Size();
+  for (NodeId predecessor : predecessors) {
+    if (predecessor >= id) {
+      throw std::out_of_range("Predecessor is not in the graph.");
+    }
+  }
+  auto node = Owned<Node>::New();
+  node->task_ = std::move(task);
+  node->predecessors_.Append(predecessors);
+  for (NodeId predecessor : predecessors) {
+    nodes_[predecessor]->successors_.PushBack(id);
+  }
+  if (predecessors.empty()) {
+    roots_.PushBack(id);
+  }
+  nodes_.EmplaceBack(std::move(node));
+  return id;
+}
+
+TaskGraph::NodeId TaskGraph::Add(Owned<Task>&& task,
+                                 std::initializer_list<NodeId> predecessors) {
+  return Add(std::move(task), std::span<const NodeId>(predecessors.begin(),
+                                                      predecessors.size()));
+}
+
+Task::Status TaskGraph::Execute() {
+  if (nodes_.IsEmpty()) {
+    return Status::Done;
+  }
+  for (auto& node : nodes_) {
+    node->pending_.store(node->predecessors_.Size(), std::memory_order_relaxed);
+  }
+  for (NodeId root : roots_) {
+    pool_.Seed(root);
+  }
+  pool_.Run(nodes_.Size(),
+            [this](size_t id, size_t worker) { RunNode(id, worker); });
+
+  for (auto& node : nodes_) {
+    if (!node->done_) {
+      return Status::Keep;
+    }
+  }
+  return Status::Done;
+}
+
+void TaskGraph::RunNode(NodeId id, size_t worker) {
+  Node& node = *nodes_[id];
+  if (node.done_) {
+    node.duration_ = std::chrono::nanoseconds(0);
+  } else {
+    PIGEON_PROFILE_ZONE(node.task_->Name());
+    auto start = std::chrono::steady_clock::now();
+    node.done_ = node.task_->Execute() == Status::Done;
+    node.duration_ = std::chrono::steady_clock::now() - start;
+  }
+  for (NodeId successor : node.successors_) {
+    // The last predecessor to finish hands the successor to its own worker.
+    if (nodes_[successor]->pending_.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+      pool_.Push(worker, successor);
+    }
+  }
+}
+
+TaskGraph::CriticalPath TaskGraph::LastCriticalPath() const {
+  CriticalPath path;
+  size_t size = nodes_.Size();
+  if (size == 0) {
+    return path;
+  }
+  // Predecessors always have smaller ids, so id order is a topological order.
+  Array<std::chrono::nanoseconds> finish;
+  Array<NodeId> previous;
+  finish.Resize(size);
+  previous.Resize(size);
+  NodeId last = 0;
+  for (NodeId id = 0; id < size; ++id) {
+    const Node& node = *nodes_[id];
+    std::chrono::nanoseconds start{0};
+    previous[id] = id;
+    for (NodeId predecessor : node.predecessors_) {
+      if (finish[predecessor] >= start) {
+        start = finish[predecessor];
+        previous[id] = predecessor;
+      }
+    }
+    finish[id] = start + node.duration_;
+    path.work_ += node.duration_;
+    if (finish[id] >= finish[last]) {
+      last = id;
+    }
+  }
+
+  path.length_ = finish[last];
+  for (NodeId id = last;; id = previous[id]) {
+    path.nodes_.PushBack(id);
+    if (previous[id] == id) {
+      break;
+    }
+  }
+  std::reverse(path.nodes_.begin(), path.nodes_.end());
+  return path;
+}
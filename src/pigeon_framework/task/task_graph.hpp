@@ -0,0 +1,71 @@
+#ifndef PIGEON_FRAMEWORK_TASK_TASK_GRAPH
+#define PIGEON_FRAMEWORK_TASK_TASK_GRAPH
+
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <span>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/worker_pool.hpp"
+
+namespace pigeon {
+
+// Tasks with dependencies, built once and replayed on every Execute. A task
+// becomes runnable as soon as its last predecessor has finished, so
+// independent branches run in parallel on the WorkerPool.
+//
+// A task returning Done is skipped on later Executes but still releases its
+// successors. The graph is Done once every task is. Park counts as Keep,
+// since every task is replayed on the next Execute anyway.
+class PIGEON_API TaskGraph : public Task {
+ public:
+  using NodeId = size_t;
+
+  struct CriticalPath {
+    // From the first task to the last one of the longest chain.
+    Array<NodeId> nodes_;
+    std::chrono::nanoseconds length_{0};
+    // Time spent in all tasks, so work_ / length_ bounds the speedup.
+    std::chrono::nanoseconds work_{0};
+  };
+
+  explicit TaskGraph(size_t thread_cnt = WorkerPool::DefaultThreadCnt());
+  ~TaskGraph() override = default;
+
+  // Predecessors must already be in the graph, which keeps it acyclic. Not
+  // allowed while Execute is running.
+  NodeId Add(Owned<Task>&& task, std::span<const NodeId> predecessors = {});
+  NodeId Add(Owned<Task>&& task, std::initializer_list<NodeId> predecessors);
+
+  Status Execute() override;
+
+  // Longest chain of dependent tasks, timed during the last Execute.
+  CriticalPath LastCriticalPath() const;
+
+  size_t Size() const { return nodes_.Size(); }
+
+  size_t ThreadCnt() const { return pool_.ThreadCnt(); }
+
+ private:
+  struct Node {
+    Owned<Task> task_;
+    Array<NodeId> predecessors_;
+    Array<NodeId> successors_;
+    std::atomic_size_t pending_{0};
+    std::chrono::nanoseconds duration_{0};
+    bool done_{false};
+  };
+
+  void RunNode(NodeId id, size_t worker);
+
+  Array<Owned<Node>> nodes_;
+  Array<NodeId> roots_;
+  WorkerPool pool_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_TASK_GRAPH
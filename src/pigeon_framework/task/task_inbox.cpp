@@ -0,0 +1,7 @@
+#include "pigeon_framework/task/task_inbox.hpp"
+
+using namespace pigeon;
+
+TaskInbox::~TaskInbox() {
+  Drain([](Owned<Task>&&) {});
+}
@@ -0,0 +1,48 @@
+#ifndef PIGEON_FRAMEWORK_TASK_TASK_INBOX
+#define PIGEON_FRAMEWORK_TASK_TASK_INBOX
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/mpsc_queue.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+
+namespace pigeon {
+
+// Lock-free way for other threads to hand tasks to the thread owning the
+// inbox, which drains it in batches.
+class PIGEON_API TaskInbox {
+ public:
+  TaskInbox() = default;
+  ~TaskInbox();
+
+  TaskInbox(const TaskInbox& other) = delete;
+  TaskInbox& operator=(const TaskInbox& other) = delete;
+
+  // Any thread.
+  void Post(Owned<Task>&& task) { queue_.Push(task.Release()); }
+
+  // Owner thread only. Hands at most `max_cnt` tasks to `sink`, returns how
+  // many it did.
+  template <std::invocable<Owned<Task>&&> F>
+  size_t Drain(F&& sink, size_t max_cnt = SIZE_MAX) {
+    size_t cnt = 0;
+    for (; cnt < max_cnt; ++cnt) {
+      Task* task = queue_.Pop();
+      if (task == nullptr) {
+        break;
+      }
+      sink(Owned<Task>(task));
+    }
+    return cnt;
+  }
+
+ private:
+  MpscQueue<Task> queue_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_TASK_INBOX
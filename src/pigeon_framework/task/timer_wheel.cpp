@@ -0,0 +1,296 @@
+#include "pigeon_framework/task/timer_wheel.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using namespace pigeon;
+
+namespace {
+
+thread_local TimerWheel* tls_wheel = nullptr;
+
+}  // namespace
+
+TimerWheel::TimerWheel(Clock::duration resolution, size_t thread_cnt,
+                       Clock::time_point start)
+    : start_(start),
+      now_(start),
+      resolution_(std::max(resolution, Clock::duration(1))),
+      pool_(thread_cnt) {
+  std::fill(std::begin(heads_), std::end(heads_), kNil);
+}
+
+TimerWheel::TimerId TimerWheel::At(Clock::time_point deadline,
+                                   Owned<Task>&& task) {
+  return Add(TickOf(deadline), 0, std::move(task), Waker());
+}
+
+TimerWheel::TimerId TimerWheel::After(Clock::duration delay,
+                                      Owned<Task>&& task) {
+  return At(now_ + delay, std::move(task));
+}
+
+TimerWheel::TimerId TimerWheel::Every(Clock::duration period,
+                                      Owned<Task>&& task) {
+  uint64_t ticks = std::max<uint64_t>(TicksOf(period), 1);
+  return Add(tick_ + ticks, ticks, std::move(task), Waker());
+}
+
+TimerWheel::TimerId TimerWheel::WakeAt(Clock::time_point deadline,
+                                       Waker waker) {
+  return Add(TickOf(deadline), 0, Owned<Task>(), std::move(waker));
+}
+
+TimerWheel::TimerId TimerWheel::WakeAfter(Clock::duration delay,
+                                          Waker waker) {
+  return WakeAt(now_ + delay, std::move(waker));
+}
+
+void TimerWheel::PostWakeAt(Clock::time_point deadline, Waker waker) {
+  std::lock_guard<std::mutex> lock(posted_mutex_);
+  posted_.PushBack({deadline, std::move(waker)});
+}
+
+TimerWheel* TimerWheel::Current() { return tls_wheel; }
+
+TimerWheel* TimerWheel::SetCurrent(TimerWheel* wheel) {
+  return std::exchange(tls_wheel, wheel);
+}
+
+bool TimerWheel::Cancel(TimerId id) {
+  auto index = static_cast<uint32_t>(id);
+  auto generation = static_cast<uint32_t>(id >> 32);
+  if (index >= timers_.Size()) {
+    return false;
+  }
+  Timer& timer = timers_[index];
+  if (timer.generation_ != generation || timer.state_ == State::Free ||
+      timer.cancelled_) {
+    return false;
+  }
+  if (timer.state_ == State::Running) {
+    // Freed once its batch is over.
+    timer.cancelled_ = true;
+  } else {
+    Unlink(index);
+    Free(index);
+  }
+  return true;
+}
+
+void TimerWheel::Advance(Clock::time_point now) {
+  if (now <= now_) {
+    return;
+  }
+  AddPending();
+  now_ = now;
+  uint64_t target = static_cast<uint64_t>((now - start_) / resolution_);
+  while (tick_ < target) {
+    size_t lowest = 0;
+    while (lowest < kLevelCnt && level_cnt_[lowest] == 0) {
+      ++lowest;
+    }
+    if (lowest == kLevelCnt) {
+      tick_ = target;
+      break;
+    } else if (lowest == 0) {
+      ++tick_;
+    } else {
+      // Nothing can happen before the lowest used level cascades.
+      size_t shift = kSlotBits * lowest;
+      uint64_t cascade = ((tick_ >> shift) + 1) << shift;
+      if (cascade > target) {
+        tick_ = target;
+        break;
+      }
+      tick_ = cascade;
+    }
+    // Refill the lower levels when their slots wrap around, top down.
+    size_t top = 0;
+    while (top + 1 < kLevelCnt &&
+           (tick_ & ((uint64_t{1} << (kSlotBits * (top + 1))) - 1)) == 0) {
+      ++top;
+    }
+    for (size_t level = top; level > 0; --level) {
+      Cascade(level);
+    }
+    Collect();
+  }
+  if (!due_.IsEmpty()) {
+    RunDue();
+  }
+}
+
+Task::Status TimerWheel::Execute() {
+  Advance(Clock::now());
+  return Status::Keep;
+}
+
+TimerWheel::TimerId TimerWheel::Add(uint64_t deadline, uint64_t period,
+                                    Owned<Task>&& task, Waker&& waker) {
+  uint32_t index;
+  if (free_.IsEmpty()) {
+    index = static_cast<uint32_t>(timers_.Size());
+    timers_.EmplaceBack();
+  } else {
+    index = free_.PopBack();
+  }
+  Timer& timer = timers_[index];
+  timer.deadline_ = std::max(deadline, tick_ + 1);
+  timer.period_ = period;
+  timer.task_ = std::move(task);
+  timer.waker_ = std::move(waker);
+  timer.state_ = State::Armed;
+  timer.cancelled_ = false;
+  Insert(index);
+  return (static_cast<TimerId>(timer.generation_) << 32) | index;
+}
+
+uint64_t TimerWheel::TickOf(Clock::time_point time) const {
+  return time <= start_ ? 0 : TicksOf(time - start_);
+}
+
+uint64_t TimerWheel::TicksOf(Clock::duration duration) const {
+  if (duration <= Clock::duration::zero()) {
+    return 0;
+  }
+  return static_cast<uint64_t>((duration + resolution_ - Clock::duration(1)) /
+                               resolution_);
+}
+
+void TimerWheel::Insert(uint32_t index) {
+  Timer& timer = timers_[index];
+  // Timers beyond the top level wait in its furthest slot and are placed
+  // again when it cascades.
+  constexpr uint64_t kRange = uint64_t{1} << (kSlotBits * kLevelCnt);
+  uint64_t deadline = std::min(timer.deadline_, tick_ + kRange - 1);
+  size_t level = 0;
+  while (level + 1 < kLevelCnt &&
+         deadline - tick_ >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+  uint32_t slot = static_cast<uint32_t>(
+      level * kSlotCnt + ((deadline >> (kSlotBits * level)) & kSlotMask));
+  timer.slot_ = slot;
+  ++level_cnt_[level];
+  timer.prev_ = kNil;
+  timer.next_ = heads_[slot];
+  if (timer.next_ != kNil) {
+    timers_[timer.next_].prev_ = index;
+  }
+  heads_[slot] = index;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+  Timer& timer = timers_[index];
+  --level_cnt_[timer.slot_ / kSlotCnt];
+  if (timer.prev_ == kNil) {
+    heads_[timer.slot_] = timer.next_;
+  } else {
+    timers_[timer.prev_].next_ = timer.next_;
+  }
+  if (timer.next_ != kNil) {
+    timers_[timer.next_].prev_ = timer.prev_;
+  }
+}
+
+void TimerWheel::Cascade(size_t level) {
+  uint32_t slot = static_cast<uint32_t>(
+      level * kSlotCnt + ((tick_ >> (kSlotBits * level)) & kSlotMask));
+  uint32_t index = std::exchange(heads_[slot], kNil);
+  while (index != kNil) {
+    uint32_t next = timers_[index].next_;
+    --level_cnt_[level];
+    Insert(index);
+    index = next;
+  }
+}
+
+void TimerWheel::Collect() {
+  uint32_t index = std::exchange(heads_[tick_ & kSlotMask], kNil);
+  while (index != kNil) {
+    Timer& timer = timers_[index];
+    timer.state_ = State::Running;
+    --level_cnt_[0];
+    due_.PushBack(index);
+    index = timer.next_;
+  }
+}
+
+void TimerWheel::RunDue() {
+  for (uint32_t index : due_) {
+    Timer& timer = timers_[index];
+    if (timer.task_.IsNull()) {
+      timer.waker_.Wake();
+      Rearm(index, Status::Done);
+    } else {
+      batch_.PushBack(index);
+      batch_tasks_.EmplaceBack(std::move(timer.task_));
+    }
+  }
+  due_.Resize(0);
+
+  // Tasks run out of timers_, which they may grow by scheduling more.
+  size_t size = batch_tasks_.Size();
+  status_.Resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    pool_.Seed(i);
+  }
+  TimerWheelScope scope(this);
+  pool_.Run(size, [this](size_t index, size_t) {
+    status_[index] = wake_queue_.Execute(batch_tasks_[index]);
+  });
+  for (size_t i = 0; i < size; ++i) {
+    timers_[batch_[i]].task_ = std::move(batch_tasks_[i]);
+    Rearm(batch_[i], status_[i]);
+  }
+  batch_.Resize(0);
+  batch_tasks_.Resize(0);
+}
+
+void TimerWheel::Rearm(uint32_t index, Status status) {
+  Timer& timer = timers_[index];
+  bool again = status == Status::Keep && !timer.task_.IsNull();
+  if (timer.cancelled_ || !again) {
+    Free(index);
+    return;
+  }
+  if (timer.period_ == 0) {
+    timer.deadline_ = tick_ + 1;
+  } else {
+    // Keep the phase, but skip the periods that were missed.
+    uint64_t missed = (tick_ - timer.deadline_) / timer.period_;
+    timer.deadline_ += (missed + 1) * timer.period_;
+  }
+  timer.state_ = State::Armed;
+  Insert(index);
+}
+
+// Takes in the tasks woken after parking and the wakes posted since the last
+// Advance.
+void TimerWheel::AddPending() {
+  wake_queue_.TakeWoken(woken_);
+  for (Owned<Task>& task : woken_) {
+    Add(tick_ + 1, 0, std::move(task), Waker());
+  }
+  woken_.Resize(0);
+
+  {
+    std::lock_guard<std::mutex> lock(posted_mutex_);
+    std::swap(posted_, posted_batch_);
+  }
+  for (PostedWake& posted : posted_batch_) {
+    WakeAt(posted.deadline_, std::move(posted.waker_));
+  }
+  posted_batch_.Resize(0);
+}
+
+void TimerWheel::Free(uint32_t index) {
+  Timer& timer = timers_[index];
+  timer.task_ = Owned<Task>();
+  timer.waker_ = Waker();
+  timer.state_ = State::Free;
+  timer.cancelled_ = false;
+  ++timer.generation_;
+  free_.PushBack(index);
+}
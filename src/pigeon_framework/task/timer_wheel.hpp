@@ -0,0 +1,161 @@
+#ifndef PIGEON_FRAMEWORK_TASK_TIMER_WHEEL
+#define PIGEON_FRAMEWORK_TASK_TIMER_WHEEL
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+#include "pigeon_framework/task/waker.hpp"
+#include "pigeon_framework/task/worker_pool.hpp"
+
+namespace pigeon {
+
+// Hierarchical timer wheel. Timers are kept in 4 levels of 256 slots, each
+// slot a linked list, so scheduling and cancelling are O(1) and a tick only
+// touches the timers that are due, plus an occasional cascade of one slot into
+// the level below. Stretches of ticks with nothing due are skipped.
+//
+// Execute advances the wheel to the current time and runs every due task in
+// one batch, on the wheel's WorkerPool. A task returning Keep runs again one
+// period later, or on the next tick if it has no period; Done retires the
+// timer. Park retires it as well, but the task is kept by its wakers like on
+// any executor, Waker::Current() being the wheel's, and runs on the first
+// tick after it is woken as a new timer without a period. Tasks waiting on a
+// timer can also park on their own executor instead:
+//
+//   wheel.WakeAfter(std::chrono::seconds(1), Waker::Current());
+//   co_await CoTask::Park();
+//
+// Not thread-safe apart from PostWakeAt; tasks run by a wheel with several
+// threads must not touch the wheel otherwise.
+class PIGEON_API TimerWheel : public Task {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimerId = uint64_t;
+
+  static constexpr size_t kLevelCnt = 4;
+  static constexpr size_t kSlotBits = 8;
+  static constexpr size_t kSlotCnt = size_t{1} << kSlotBits;
+
+  explicit TimerWheel(
+      Clock::duration resolution = std::chrono::milliseconds(1),
+      size_t thread_cnt = 1, Clock::time_point start = Clock::now());
+  ~TimerWheel() override = default;
+
+  // Deadlines are rounded up to the next tick, and deadlines in the past
+  // fire on the next one.
+  TimerId At(Clock::time_point deadline, Owned<Task>&& task);
+  TimerId After(Clock::duration delay, Owned<Task>&& task);
+  TimerId Every(Clock::duration period, Owned<Task>&& task);
+
+  TimerId WakeAt(Clock::time_point deadline, Waker waker);
+  TimerId WakeAfter(Clock::duration delay, Waker waker);
+
+  // Like WakeAt, but from any thread. The timer is added on the next Advance.
+  void PostWakeAt(Clock::time_point deadline, Waker waker);
+
+  // Wheel of the TimerWheelScope on this thread, null outside of any. Timed
+  // CoTask waits park with it.
+  static TimerWheel* Current();
+
+  // False if the timer already fired for good or was cancelled.
+  bool Cancel(TimerId id);
+
+  // Fires everything due by `now`.
+  void Advance(Clock::time_point now);
+
+  Status Execute() override;
+
+  // Time of the last Advance, delays are relative to it.
+  Clock::time_point Now() const { return now_; }
+
+  size_t Size() const { return timers_.Size() - free_.Size(); }
+
+  size_t ThreadCnt() const { return pool_.ThreadCnt(); }
+
+ private:
+  friend class TimerWheelScope;
+
+  static constexpr uint32_t kNil = UINT32_MAX;
+  static constexpr uint64_t kSlotMask = kSlotCnt - 1;
+
+  enum class State : uint8_t { Free, Armed, Running };
+
+  struct Timer {
+    uint64_t deadline_{0};
+    uint64_t period_{0};
+    Owned<Task> task_;
+    Waker waker_;
+    uint32_t prev_{kNil};
+    uint32_t next_{kNil};
+    uint32_t slot_{0};
+    uint32_t generation_{1};
+    State state_{State::Free};
+    bool cancelled_{false};
+  };
+
+  struct PostedWake {
+    Clock::time_point deadline_;
+    Waker waker_;
+  };
+
+  static TimerWheel* SetCurrent(TimerWheel* wheel);
+
+  TimerId Add(uint64_t deadline, uint64_t period, Owned<Task>&& task,
+              Waker&& waker);
+  uint64_t TickOf(Clock::time_point time) const;
+  uint64_t TicksOf(Clock::duration duration) const;
+  void Insert(uint32_t index);
+  void Unlink(uint32_t index);
+  void Cascade(size_t level);
+  void Collect();
+  void RunDue();
+  void Rearm(uint32_t index, Status status);
+  void Free(uint32_t index);
+  void AddPending();
+
+  Clock::time_point start_;
+  Clock::time_point now_;
+  Clock::duration resolution_;
+  uint64_t tick_{0};
+
+  Array<Timer> timers_;
+  Array<uint32_t> free_;
+  uint32_t heads_[kLevelCnt * kSlotCnt];
+  size_t level_cnt_[kLevelCnt]{};
+
+  Array<uint32_t> due_;
+  Array<uint32_t> batch_;
+  Array<Owned<Task>> batch_tasks_;
+  Array<Status> status_;
+  WakeQueue wake_queue_;
+  Array<Owned<Task>> woken_;
+  std::mutex posted_mutex_;
+  Array<PostedWake> posted_;
+  Array<PostedWake> posted_batch_;
+  WorkerPool pool_;
+};
+
+// Makes a wheel TimerWheel::Current() on this thread. Application does so for
+// its frames, a wheel for its own tasks, and a WorkerPool passes the wheel of
+// the thread calling Run on to its workers.
+class TimerWheelScope {
+ public:
+  explicit TimerWheelScope(TimerWheel* wheel)
+      : outer_(TimerWheel::SetCurrent(wheel)) {}
+
+  TimerWheelScope(const TimerWheelScope& other) = delete;
+  TimerWheelScope& operator=(const TimerWheelScope& other) = delete;
+
+  ~TimerWheelScope() { TimerWheel::SetCurrent(outer_); }
+
+ private:
+  TimerWheel* outer_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_TIMER_WHEEL
@@ -0,0 +1,138 @@
+#include "pigeon_framework/task/waker.hpp"
+
+#include <utility>
+#include "pigeon_framework/base/profile/profiler.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+struct WakeContext {
+  WakeList* list_;
+  SharedAsync<WakeSlot> slot_;
+};
+
+// Set while a WakeQueue executes a task on this thread.
+thread_local WakeContext* tls_context = nullptr;
+
+}  // namespace
+
+WakeList::~WakeList() = default;
+
+void WakeList::Push(Owned<Task>&& task) {
+  Owned<Waker> parent;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    woken_.EmplaceBack(std::move(task));
+    --parked_cnt_;
+    parent = std::move(parent_);
+  }
+  if (!parent.IsNull()) {
+    parent->Wake();
+  }
+}
+
+void WakeList::Forget() {
+  Owned<Waker> parent;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--parked_cnt_ == 0) {
+      // Lets a parked executor find out it is done.
+      parent = std::move(parent_);
+    }
+  }
+  if (!parent.IsNull()) {
+    parent->Wake();
+  }
+}
+
+WakeSlot::~WakeSlot() {
+  if (!task_.IsNull()) {
+    task_ = Owned<Task>();
+    list_->Forget();
+  }
+}
+
+void WakeSlot::Wake() {
+  // Woken while running is seen by the executor when the task returns.
+  if (state_.exchange(State::Woken, std::memory_order_acq_rel) ==
+      State::Parked) {
+    list_->Push(std::move(task_));
+  }
+}
+
+Waker Waker::Current() {
+  WakeContext* context = tls_context;
+  if (context == nullptr) {
+    return Waker();
+  }
+  if (context->slot_.IsNull()) {
+    context->slot_ =
+        SharedAsync<WakeSlot>::New(SharedAsync<WakeList>(context->list_));
+  }
+  return Waker(context->slot_.Clone());
+}
+
+void Waker::Wake() const {
+  if (!slot_.IsNull()) {
+    slot_->Wake();
+  }
+}
+
+Task::Status WakeQueue::Execute(Owned<Task>& task) {
+  WakeContext context{list_.Get(), {}};
+  WakeContext* outer = std::exchange(tls_context, &context);
+  Task::Status status;
+  try {
+    PIGEON_PROFILE_ZONE(task->Name());
+    status = task->Execute();
+  } catch (...) {
+    tls_context = outer;
+    throw;
+  }
+  tls_context = outer;
+  if (status != Task::Status::Park) {
+    return status;
+  }
+  if (context.slot_.IsNull()) {
+    task = Owned<Task>();
+    return status;
+  }
+
+  WakeSlot& slot = *context.slot_;
+  slot.task_ = std::move(task);
+  {
+    std::lock_guard<std::mutex> lock(list_->mutex_);
+    ++list_->parked_cnt_;
+  }
+  auto expected = WakeSlot::State::Running;
+  if (slot.state_.compare_exchange_strong(expected, WakeSlot::State::Parked,
+                                          std::memory_order_acq_rel)) {
+    return status;
+  }
+  {
+    std::lock_guard<std::mutex> lock(list_->mutex_);
+    --list_->parked_cnt_;
+  }
+  task = std::move(slot.task_);
+  return Task::Status::Keep;
+}
+
+size_t WakeQueue::ParkedCnt() const {
+  std::lock_guard<std::mutex> lock(list_->mutex_);
+  return list_->parked_cnt_;
+}
+
+Task::Status WakeQueue::Idle() {
+  Waker waker = Waker::Current();
+  std::lock_guard<std::mutex> lock(list_->mutex_);
+  if (!list_->woken_.IsEmpty()) {
+    return Task::Status::Keep;
+  }
+  if (list_->parked_cnt_ == 0) {
+    return Task::Status::Done;
+  }
+  list_->parent_ = waker.IsNull() ? Owned<Waker>()
+                                  : Owned<Waker>::New(std::move(waker));
+  return Task::Status::Park;
+}
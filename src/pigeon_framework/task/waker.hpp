@@ -0,0 +1,122 @@
+#ifndef PIGEON_FRAMEWORK_TASK_WAKER
+#define PIGEON_FRAMEWORK_TASK_WAKER
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/auto_ptr/shared.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/define.hpp"
+#include "pigeon_framework/task/task.hpp"
+
+namespace pigeon {
+
+class Waker;
+
+// Tasks woken since the executor last looked. Shared with the slots of the
+// parked tasks, so waking stays safe after the executor is gone.
+class PIGEON_API WakeList : public RefCounted<ThreadSafeRefCount> {
+ public:
+  WakeList() = default;
+  ~WakeList();
+
+ private:
+  friend class WakeQueue;
+  friend class WakeSlot;
+
+  void Push(Owned<Task>&& task);
+  void Forget();
+
+  std::mutex mutex_;
+  Array<Owned<Task>> woken_;
+  size_t parked_cnt_{0};
+  // Waker of the executor itself while it is parked.
+  Owned<Waker> parent_;
+};
+
+// Holds a parked task until one of its wakers fires.
+class PIGEON_API WakeSlot : public RefCounted<ThreadSafeRefCount> {
+ public:
+  explicit WakeSlot(SharedAsync<WakeList>&& list) : list_(std::move(list)) {}
+  ~WakeSlot();
+
+  void Wake();
+
+ private:
+  friend class WakeQueue;
+
+  enum class State : uint8_t { Running, Parked, Woken };
+
+  std::atomic<State> state_{State::Running};
+  Owned<Task> task_;
+  SharedAsync<WakeList> list_;
+};
+
+// Handle that puts a parked task back on its executor. A task takes one with
+// Current() during Execute, hands it to whatever it waits for and returns
+// Park. Wakers are thread-safe and wake the task at most once; a task that
+// parks again needs a new one.
+class PIGEON_API Waker {
+ public:
+  Waker() = default;
+
+  Waker(const Waker& other) : slot_(other.slot_.Clone()) {}
+  Waker(Waker&& other) noexcept = default;
+
+  Waker& operator=(const Waker& other) = default;
+  Waker& operator=(Waker&& other) noexcept = default;
+
+  // Waker of the task executing on this thread, null outside of executors.
+  static Waker Current();
+
+  void Wake() const;
+
+  bool IsNull() const { return slot_.IsNull(); }
+
+ private:
+  explicit Waker(SharedAsync<WakeSlot>&& slot) : slot_(std::move(slot)) {}
+
+  SharedAsync<WakeSlot> slot_;
+};
+
+// Executor side of parking. Parked tasks are owned by their wakers rather
+// than by the executor, so they cost nothing per tick; a parked task whose
+// wakers are all gone can never run again and is destroyed.
+class PIGEON_API WakeQueue {
+ public:
+  WakeQueue() : list_(SharedAsync<WakeList>::New()) {}
+
+  WakeQueue(const WakeQueue& other) = delete;
+  WakeQueue& operator=(const WakeQueue& other) = delete;
+
+  // Executes `task` with a Waker available to it. On Park the task is moved
+  // out of `task`, unless it was woken before it returned, which counts as
+  // Keep.
+  Task::Status Execute(Owned<Task>& task);
+
+  // Moves the tasks woken since the last call to the end of `tasks`.
+  template <typename Tasks>
+  void TakeWoken(Tasks& tasks) {
+    std::lock_guard<std::mutex> lock(list_->mutex_);
+    auto& woken = list_->woken_;
+    tasks.Append(std::make_move_iterator(woken.begin()),
+                 std::make_move_iterator(woken.end()));
+    woken.Resize(0);
+  }
+
+  size_t ParkedCnt() const;
+
+  // Status of an executor without runnable tasks: Done when nothing is
+  // parked either, otherwise Park with the executor's own waker fired by the
+  // first wake.
+  Task::Status Idle();
+
+ private:
+  SharedAsync<WakeList> list_;
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_WAKER
@@ -0,0 +1,188 @@
+#include "pigeon_framework/task/worker_pool.hpp"
+
+#include "pigeon_framework/task/timer_wheel.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+// Failed rounds of popping and stealing before a worker sleeps.
+constexpr size_t kIdleRoundCnt = 64;
+
+}  // namespace
+
+WorkerPool::WorkerPool(size_t thread_cnt) {
+  if (thread_cnt == 0) {
+    thread_cnt = 1;
+  }
+  workers_.Reserve(thread_cnt);
+  for (size_t i = 0; i < thread_cnt; ++i) {
+    workers_.EmplaceBack(Owned<Worker>::New());
+    workers_[i]->seed_ = i * 0x9E3779B97F4A7C15ull + 1;
+  }
+  for (size_t i = 1; i < thread_cnt; ++i) {
+    workers_[i]->thread_ = std::thread([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker->thread_.joinable()) {
+      worker->thread_.join();
+    }
+  }
+}
+
+size_t WorkerPool::DefaultThreadCnt() {
+  size_t cnt = std::thread::hardware_concurrency();
+  return cnt == 0 ? 1 : cnt;
+}
+
+void WorkerPool::Seed(size_t index) {
+  // Workers are parked between runs, so this thread may fill every deque.
+  workers_[next_seed_]->deque_.Push(index);
+  next_seed_ = (next_seed_ + 1) % workers_.Size();
+}
+
+void WorkerPool::Push(size_t worker, size_t index) {
+  workers_[worker]->deque_.Push(index);
+  push_cnt_.fetch_add(1, std::memory_order_seq_cst);
+  if (parked_cnt_.load(std::memory_order_seq_cst) != 0) {
+    WakeParked(false);
+  }
+}
+
+void WorkerPool::Run(Job& job, size_t item_cnt) {
+  if (item_cnt == 0) {
+    return;
+  }
+  job_ = &job;
+  tag_ = MemoryTracker::CurrentTag();
+  wheel_ = TimerWheel::Current();
+  next_seed_ = 0;
+  remaining_.store(item_cnt, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++epoch_;
+    active_cnt_ = workers_.Size() - 1;
+  }
+  wake_.notify_all();
+
+  RunWorker(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return active_cnt_ == 0; });
+  job_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop(size_t self) {
+  size_t epoch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this, epoch] { return stop_ || epoch_ != epoch; });
+      if (stop_) {
+        return;
+      }
+      epoch = epoch_;
+    }
+    RunWorker(self);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--active_cnt_ == 0) {
+        idle_.notify_one();
+      }
+    }
+  }
+}
+
+void WorkerPool::RunWorker(size_t self) {
+  MemoryTagScope scope(tag_);
+  TimerWheelScope wheel_scope(wheel_);
+  size_t idle_round_cnt = 0;
+  while (remaining_.load(std::memory_order_acquire) != 0) {
+    size_t index;
+    if (!TryTake(self, index)) {
+      if (++idle_round_cnt < kIdleRoundCnt) {
+        std::this_thread::yield();
+        continue;
+      }
+      idle_round_cnt = 0;
+      if (!Park(self, index)) {
+        continue;
+      }
+    }
+    idle_round_cnt = 0;
+    job_->Run(index, self);
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      WakeParked(true);
+    }
+  }
+}
+
+bool WorkerPool::TryTake(size_t self, size_t& index) {
+  if (auto popped = workers_[self]->deque_.Pop()) {
+    index = *popped;
+    return true;
+  }
+  return TrySteal(self, index);
+}
+
+bool WorkerPool::TrySteal(size_t self, size_t& index) {
+  size_t worker_cnt = workers_.Size();
+  if (worker_cnt == 1) {
+    return false;
+  }
+  // xorshift, only to spread thieves over the victims.
+  uint64_t& seed = workers_[self]->seed_;
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  size_t start = seed % worker_cnt;
+  for (size_t i = 0; i < worker_cnt; ++i) {
+    size_t victim = (start + i) % worker_cnt;
+    if (victim == self) {
+      continue;
+    }
+    if (auto stolen = workers_[victim]->deque_.Steal()) {
+      index = *stolen;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Sleeps until an item is pushed or the run is over, unless a last look
+// finds an item, which is returned in `index`.
+bool WorkerPool::Park(size_t self, size_t& index) {
+  // An item pushed after this read changes push_cnt_, one pushed before is
+  // found by the last look.
+  uint64_t push_cnt = push_cnt_.load(std::memory_order_seq_cst);
+  if (TryTake(self, index)) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(park_mutex_);
+  parked_cnt_.fetch_add(1, std::memory_order_seq_cst);
+  parked_.wait(lock, [this, push_cnt] {
+    return push_cnt_.load(std::memory_order_seq_cst) != push_cnt ||
+           remaining_.load(std::memory_order_acquire) == 0;
+  });
+  parked_cnt_.fetch_sub(1, std::memory_order_relaxed);
+  return false;
+}
+
+void WorkerPool::WakeParked(bool all) {
+  // Taking the lock orders this after a worker's last check before it waits.
+  {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+  }
+  if (all) {
+    parked_.notify_all();
+  } else {
+    parked_.notify_one();
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef PIGEON_FRAMEWORK_TASK_WORKER_POOL
+#define PIGEON_FRAMEWORK_TASK_WORKER_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/base/container/work_stealing_deque.hpp"
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+#include "pigeon_framework/define.hpp"
+
+namespace pigeon {
+
+class TimerWheel;
+
+// Fixed pool of worker threads plus the thread calling Run. Work items are
+// indices into whatever the caller runs; every worker owns a work-stealing
+// deque and idle workers steal from the others. Workers that keep finding
+// nothing sleep until an item is pushed or the run is over.
+class PIGEON_API WorkerPool {
+ public:
+  class Job {
+   public:
+    virtual ~Job() = default;
+    virtual void Run(size_t index, size_t worker) = 0;
+  };
+
+  explicit WorkerPool(size_t thread_cnt = DefaultThreadCnt());
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool& other) = delete;
+  WorkerPool& operator=(const WorkerPool& other) = delete;
+
+  // Queue an item before Run, items are spread over the workers.
+  void Seed(size_t index);
+
+  // Queue an item from inside Job::Run, on the deque of that worker.
+  void Push(size_t worker, size_t index);
+
+  // Run queued items until `item_cnt` of them have finished, including items
+  // pushed while running. Worker 0 is the calling thread.
+  void Run(Job& job, size_t item_cnt);
+
+  template <typename F>
+  void Run(size_t item_cnt, F&& run) {
+    struct FunctionJob : public Job {
+      explicit FunctionJob(F& run) : run_(run) {}
+      void Run(size_t index, size_t worker) override { run_(index, worker); }
+      F& run_;
+    } job(run);
+    Run(job, item_cnt);
+  }
+
+  size_t ThreadCnt() const { return workers_.Size(); }
+
+  static size_t DefaultThreadCnt();
+
+ private:
+  struct Worker {
+    WorkStealingDeque<size_t> deque_;
+    std::thread thread_;
+    uint64_t seed_;
+  };
+
+  void WorkerLoop(size_t self);
+  void RunWorker(size_t self);
+  bool TryTake(size_t self, size_t& index);
+  bool TrySteal(size_t self, size_t& index);
+  bool Park(size_t self, size_t& index);
+  void WakeParked(bool all);
+
+  Array<Owned<Worker>> workers_;
+  size_t next_seed_{0};
+  Job* job_{nullptr};
+  // Workers charge allocations to the tag of the thread calling Run, and see
+  // its current TimerWheel.
+  MemoryTag tag_{kMemoryTagGeneral};
+  TimerWheel* wheel_{nullptr};
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  size_t epoch_{0};
+  size_t active_cnt_{0};
+  bool stop_{false};
+  std::atomic_size_t remaining_{0};
+
+  // Pushes bump push_cnt_, which parked workers wait to change.
+  std::mutex park_mutex_;
+  std::condition_variable parked_;
+  std::atomic_size_t parked_cnt_{0};
+  std::atomic_uint64_t push_cnt_{0};
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TASK_WORKER_POOL
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/auto_ptr/shared.hpp"
+#include "pigeon_framework/base/auto_ptr/unretained.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/base/memory/allocator.hpp"
+#include "counting_resource.hpp"
+
+using namespace pigeon;
+
+TEST(AllocatorTests, ArrayAllocatesFromResource) {
+  CountingResource resource;
+  {
+    Array<int32_t, ResourceAllocator> array(&resource);
+    array.PushBack(0);
+    array.PushBack(1);
+    array.PushBack(2);
+    EXPECT_EQ(resource.alloc_cnt_, 3);
+    EXPECT_EQ(resource.live_bytes_, 4 * sizeof(int32_t));
+
+    auto copied = array;
+    EXPECT_EQ(copied.GetAllocator().Resource(), &resource);
+    EXPECT_EQ(resource.alloc_cnt_, 4);
+  }
+  EXPECT_EQ(resource.live_bytes_, 0);
+}
+
+TEST(AllocatorTests, InlineArraySkipsResource) {
+  CountingResource resource;
+  InlineArray<int32_t, 2, ResourceAllocator> array(&resource);
+  array.PushBack(0);
+  array.PushBack(1);
+  EXPECT_EQ(resource.alloc_cnt_, 0);
+  array.PushBack(2);
+  EXPECT_EQ(resource.alloc_cnt_, 1);
+}
+
+TEST(AllocatorTests, AutoPtrAllocatesFromResource) {
+  CountingResource resource;
+  ResourceAllocator allocator(&resource);
+  {
+    auto owned = Owned<int32_t>::NewIn(allocator, 1);
+    EXPECT_EQ(*owned, 1);
+    EXPECT_EQ(resource.alloc_cnt_, 1);
+
+    auto shared = SharedAsync<int32_t>::NewIn(allocator, 2);
+    auto unretained = UnretainedAsync<int32_t>(shared);
+    EXPECT_EQ(*shared, 2);
+    EXPECT_EQ(resource.alloc_cnt_, 2);
+  }
+  EXPECT_EQ(resource.live_bytes_, 0);
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/application.hpp"
+
+using namespace pigeon;
+using namespace std::chrono_literals;
+
+namespace {
+
+class CountTask : public Task {
+ public:
+  explicit CountTask(int32_t* cnt, Application::Clock::duration busy = {})
+      : cnt_(cnt), busy_(busy) {}
+
+  Status Execute() override {
+    ++*cnt_;
+    if (busy_ > Application::Clock::duration::zero()) {
+      std::this_thread::sleep_for(busy_);
+    }
+    return Status::Keep;
+  }
+
+ private:
+  int32_t* cnt_;
+  Application::Clock::duration busy_;
+};
+
+class StopTask : public Task {
+ public:
+  StopTask(Application* app, uint64_t frame_cnt)
+      : app_(app), frame_cnt_(frame_cnt) {}
+
+  Status Execute() override {
+    if (app_->FrameCnt() + 1 == frame_cnt_) {
+      app_->Stop();
+      return Status::Done;
+    }
+    return Status::Keep;
+  }
+
+ private:
+  Application* app_;
+  uint64_t frame_cnt_;
+};
+
+class HookedApplication : public Application {
+ public:
+  std::vector<int32_t> calls_;
+
+ protected:
+  void OnStart() override { calls_.push_back(0); }
+  void OnStop() override { calls_.push_back(1); }
+};
+
+}  // namespace
+
+TEST(ApplicationTests, FixedStep) {
+  Application::Config config;
+  config.fixed_step_ = 10ms;
+  config.max_fixed_step_cnt_ = 4;
+  Application app(config);
+  int32_t fixed = 0;
+  int32_t frame = 0;
+  app.PushFixed(Owned<CountTask>::New(&fixed));
+  app.PushFrame(Owned<CountTask>::New(&frame));
+
+  auto start = Application::Clock::now();
+  app.Tick(start);
+  EXPECT_EQ(fixed, 0);
+  EXPECT_EQ(frame, 1);
+  app.Tick(start + 25ms);
+  EXPECT_EQ(fixed, 2);
+  EXPECT_EQ(app.FrameTime(), 25ms);
+  EXPECT_DOUBLE_EQ(app.Alpha(), 0.5);
+  app.Tick(start + 30ms);
+  EXPECT_EQ(fixed, 3);
+  EXPECT_DOUBLE_EQ(app.Alpha(), 0.0);
+
+  // A long stall only catches up on a bounded number of steps.
+  app.Tick(start + 1s);
+  EXPECT_EQ(fixed, 7);
+  EXPECT_EQ(app.FixedStepCnt(), 7);
+  EXPECT_EQ(frame, 4);
+  EXPECT_EQ(app.FrameCnt(), 4);
+}
+
+TEST(ApplicationTests, FrameBudget) {
+  Application::Config config;
+  config.frame_budget_ = 1ms;
+  Application app(config);
+  int32_t high = 0;
+  int32_t normal = 0;
+  int32_t low = 0;
+  app.PushFrame(Owned<CountTask>::New(&high, 2ms), Application::Priority::High);
+  app.PushFrame(Owned<CountTask>::New(&normal), Application::Priority::Normal);
+  app.PushFrame(Owned<CountTask>::New(&low), Application::Priority::Low);
+
+  auto now = Application::Clock::now();
+  app.Tick(now);
+  EXPECT_EQ(high, 1);
+  EXPECT_EQ(normal, 0);
+  EXPECT_EQ(low, 0);
+  EXPECT_TRUE(app.IsDeferred(Application::Priority::Normal));
+  EXPECT_TRUE(app.IsDeferred(Application::Priority::Low));
+
+  // Deferred work runs on the next frame even if it is over budget again.
+  app.Tick(now + 16ms);
+  EXPECT_EQ(high, 2);
+  EXPECT_EQ(normal, 1);
+  EXPECT_EQ(low, 1);
+  EXPECT_FALSE(app.IsDeferred(Application::Priority::Normal));
+}
+
+TEST(ApplicationTests, Timers) {
+  Application app;
+  int32_t fired = 0;
+  auto start = Application::Clock::now();
+  app.Timers().At(start + 5ms, Owned<CountTask>::New(&fired));
+  app.Tick(start);
+  EXPECT_EQ(fired, 0);
+  app.Tick(start + 10ms);
+  EXPECT_EQ(fired, 1);
+
+  // Frame tasks see the application's wheel, so timed waits can park on it.
+  class WheelTask : public Task {
+   public:
+    explicit WheelTask(TimerWheel** wheel) : wheel_(wheel) {}
+
+    Status Execute() override {
+      *wheel_ = TimerWheel::Current();
+      return Status::Done;
+    }
+
+   private:
+    TimerWheel** wheel_;
+  };
+  TimerWheel* wheel = nullptr;
+  app.PushFrame(Owned<WheelTask>::New(&wheel));
+  app.Tick(start + 20ms);
+  EXPECT_EQ(wheel, &app.Timers());
+  EXPECT_EQ(TimerWheel::Current(), nullptr);
+}
+
+TEST(ApplicationTests, Run) {
+  HookedApplication app;
+  int32_t frame = 0;
+  app.PushFrame(Owned<CountTask>::New(&frame));
+  app.PushFrame(Owned<StopTask>::New(&app, 3), Application::Priority::Low);
+  app.Run();
+  EXPECT_EQ(app.calls_, std::vector<int32_t>({0, 1}));
+  EXPECT_EQ(app.FrameCnt(), 3);
+  EXPECT_EQ(frame, 3);
+}
+
+TEST(ApplicationTests, StopBeforeRun) {
+  HookedApplication app;
+  int32_t frame = 0;
+  app.PushFrame(Owned<CountTask>::New(&frame));
+  app.Stop();
+  app.Run();
+  EXPECT_EQ(app.calls_, std::vector<int32_t>({0, 1}));
+  EXPECT_EQ(frame, 0);
+
+  // The stop is used up, the next Run goes on until the next one.
+  app.PushFrame(Owned<StopTask>::New(&app, 2), Application::Priority::Low);
+  app.Run();
+  EXPECT_EQ(app.calls_, std::vector<int32_t>({0, 1, 0, 1}));
+  EXPECT_EQ(app.FrameCnt(), 2);
+  EXPECT_EQ(frame, 2);
+}
+
+TEST(ApplicationTests, PostTask) {
+  Application::Config config;
+  config.max_posted_cnt_ = 100;
+  Application app(config);
+  int32_t executed = 0;
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&app, &executed] {
+      for (int32_t j = 0; j < 50; ++j) {
+        app.PostTask(Owned<CountTask>::New(&executed),
+                     Application::Priority::High);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto now = Application::Clock::now();
+  app.Tick(now);
+  EXPECT_EQ(executed, 100);
+  app.Tick(now);
+  EXPECT_EQ(executed, 300);
+}
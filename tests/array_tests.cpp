@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <array>
 #include <exception>
 #include <iterator>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string>
 #include "pigeon_framework/base/auto_ptr/owned.hpp"
 #include "pigeon_framework/base/container/array.hpp"
 
@@ -29,11 +33,12 @@ TEST(ArrayTests, MoveConstructed) {
   };
 
   {
-    Array<Owned<int32_t>> src;
-    src.EmplaceBack(Owned<int32_t>(new int32_t(0), destructor));
-    src.EmplaceBack(Owned<int32_t>(new int32_t(1), destructor));
+    using CountedOwned = Owned<int32_t, decltype(destructor)>;
+    Array<CountedOwned> src;
+    src.EmplaceBack(CountedOwned(new int32_t(0), destructor));
+    src.EmplaceBack(CountedOwned(new int32_t(1), destructor));
     auto* raw_src = src.Get();
-    Array<Owned<int32_t>> dst(std::move(src));
+    Array<CountedOwned> dst(std::move(src));
     EXPECT_TRUE(src.IsEmpty());
     EXPECT_EQ(*dst[0], 0);
     EXPECT_EQ(*dst[1], 1);
@@ -65,11 +70,12 @@ TEST(ArrayTests, SetByMove) {
     destruct_cnt += 1;
   };
 
-  Array<Owned<int32_t>> src;
-  src.EmplaceBack(Owned<int32_t>(new int32_t(0), destructor));
-  src.EmplaceBack(Owned<int32_t>(new int32_t(1), destructor));
-  Array<Owned<int32_t>> dst;
-  dst.EmplaceBack(Owned<int32_t>(new int32_t(2), destructor));
+  using CountedOwned = Owned<int32_t, decltype(destructor)>;
+  Array<CountedOwned> src;
+  src.EmplaceBack(CountedOwned(new int32_t(0), destructor));
+  src.EmplaceBack(CountedOwned(new int32_t(1), destructor));
+  Array<CountedOwned> dst;
+  dst.EmplaceBack(CountedOwned(new int32_t(2), destructor));
   dst = std::move(src);
   EXPECT_TRUE(src.IsEmpty());
   EXPECT_EQ(*dst[0], 0);
@@ -160,3 +166,240 @@ TEST(ArrayTests, IterateArray) {
     EXPECT_EQ(arr_iter[i], cmp_iter[i]);
   }
 }
+
+TEST(ArrayTests, NonDefaultInitializable) {
+  struct Value {
+    explicit Value(int32_t num) : num_(num) {}
+    int32_t num_;
+  };
+
+  Array<Value> array;
+  array.EmplaceBack(0);
+  array.EmplaceBack(1);
+  array.PushBack(array[0]);  // Refer into the array while it grows.
+  EXPECT_EQ(array.Size(), 3);
+  EXPECT_EQ(array[2].num_, 0);
+  EXPECT_THROW(array.Resize(4), std::invalid_argument);
+}
+
+TEST(ArrayTests, OnlyConstructSize) {
+  static int32_t live_cnt = 0;
+  struct Counted {
+    Counted() { ++live_cnt; }
+    Counted(const Counted&) { ++live_cnt; }
+    Counted(Counted&&) noexcept { ++live_cnt; }
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&&) noexcept = default;
+    ~Counted() { --live_cnt; }
+  };
+
+  {
+    Array<Counted> array;
+    array.Reserve(16);
+    EXPECT_EQ(live_cnt, 0);
+    for (int32_t i = 0; i < 20; ++i) {
+      array.EmplaceBack();
+    }
+    EXPECT_EQ(live_cnt, 20);
+    array.PopBack();
+    array.Resize(10);
+    EXPECT_EQ(live_cnt, 10);
+    array.ShrinkToFit();
+    EXPECT_EQ(live_cnt, 10);
+  }
+  EXPECT_EQ(live_cnt, 0);
+}
+
+TEST(ArrayTests, InlineCapacity) {
+  InlineArray<int32_t, 4> array = {0, 1, 2};
+  auto* inline_data = array.Get();
+  EXPECT_EQ(array.Capacity(), 4);
+  EXPECT_TRUE(reinterpret_cast<char*>(inline_data) >=
+                  reinterpret_cast<char*>(&array) &&
+              reinterpret_cast<char*>(inline_data) <
+                  reinterpret_cast<char*>(&array + 1));
+
+  array.PushBack(3);
+  EXPECT_EQ(array.Get(), inline_data);
+  array.PushBack(4);
+  EXPECT_NE(array.Get(), inline_data);
+  EXPECT_EQ(array.Capacity(), 8);
+
+  array.Resize(2);
+  array.ShrinkToFit();
+  EXPECT_EQ(array.Get(), inline_data);
+  EXPECT_EQ(array.Capacity(), 4);
+  EXPECT_EQ(array, (InlineArray<int32_t, 4>{0, 1}));
+
+  array.Clear();
+  EXPECT_EQ(array.Get(), inline_data);
+  EXPECT_TRUE(array.IsEmpty());
+}
+
+TEST(ArrayTests, InlineMove) {
+  int32_t destruct_cnt = 0;
+  auto destructor = [&destruct_cnt](int32_t* ptr) {
+    delete ptr;
+    destruct_cnt += 1;
+  };
+
+  {
+    using CountedOwned = Owned<int32_t, decltype(destructor)>;
+    InlineArray<CountedOwned, 2> src;
+    src.EmplaceBack(CountedOwned(new int32_t(0), destructor));
+    InlineArray<CountedOwned, 2> dst(std::move(src));
+    EXPECT_TRUE(src.IsEmpty());
+    EXPECT_EQ(*dst[0], 0);
+
+    dst.EmplaceBack(CountedOwned(new int32_t(1), destructor));
+    dst.EmplaceBack(CountedOwned(new int32_t(2), destructor));
+    auto* heap_data = dst.Get();
+    src = std::move(dst);
+    EXPECT_EQ(src.Get(), heap_data);
+    EXPECT_EQ(*src[2], 2);
+    EXPECT_TRUE(dst.IsEmpty());
+    EXPECT_EQ(dst.Capacity(), 2);
+    EXPECT_EQ(destruct_cnt, 0);
+  }
+  EXPECT_EQ(destruct_cnt, 3);
+}
+
+TEST(ArrayTests, RangeOps) {
+  Array<int32_t> array = {0, 5};
+  std::array<int32_t, 3> middle = {1, 2, 3};
+  array.InsertRange(1, std::span<const int32_t>(middle));  // 0, 1, 2, 3, 5
+  array.Emplace(4, 4);                                    // 0, 1, 2, 3, 4, 5
+  array.Append(middle.begin(), middle.end());  // 0, 1, 2, 3, 4, 5, 1, 2, 3
+  EXPECT_EQ(array, (Array<int32_t>{0, 1, 2, 3, 4, 5, 1, 2, 3}));
+
+  array.EraseRange(6, 3);  // 0, 1, 2, 3, 4, 5
+  EXPECT_EQ(array.EraseIf([](int32_t num) { return num % 2 == 1; }), 3);
+  EXPECT_EQ(array, (Array<int32_t>{0, 2, 4}));
+  EXPECT_EQ(array.RetainIf([](int32_t num) { return num != 0; }), 1);
+  EXPECT_EQ(array, (Array<int32_t>{2, 4}));
+
+  EXPECT_THROW(array.EraseRange(1, 2), std::out_of_range);
+  EXPECT_THROW(array.Emplace(3, 0), std::out_of_range);
+}
+
+TEST(ArrayTests, RangeOpsThrowingCopy) {
+  static int32_t live_cnt = 0;
+  static int32_t copy_budget = 0;
+  struct Fragile {
+    explicit Fragile(int32_t val) : val_(val) { ++live_cnt; }
+    Fragile(const Fragile& other) : val_(other.val_) {
+      if (copy_budget-- == 0) {
+        throw std::runtime_error("Copy failed.");
+      }
+      ++live_cnt;
+    }
+    Fragile(Fragile&& other) noexcept : val_(other.val_) { ++live_cnt; }
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) noexcept = default;
+    ~Fragile() { --live_cnt; }
+
+    int32_t val_;
+  };
+
+  {
+    Array<Fragile> array;
+    for (int32_t i = 0; i < 4; ++i) {
+      array.EmplaceBack(i);
+    }
+    std::array<Fragile, 3> items = {Fragile(10), Fragile(11), Fragile(12)};
+    // Once in place, once growing.
+    for (size_t capacity : {size_t(8), size_t(4)}) {
+      array.ShrinkToFit();
+      array.Reserve(capacity);
+      copy_budget = 2;
+      EXPECT_THROW(array.InsertRange(1, items.begin(), items.end()),
+                   std::runtime_error);
+      EXPECT_EQ(array.Size(), 4);
+      for (int32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(array[i].val_, i);
+      }
+      EXPECT_EQ(live_cnt, 7);
+    }
+  }
+  EXPECT_EQ(live_cnt, 0);
+}
+
+TEST(ArrayTests, RangeOpsMoveOnly) {
+  Array<Owned<int32_t>> array;
+  for (int32_t i = 0; i < 6; ++i) {
+    array.EmplaceBack(Owned<int32_t>::New(i));
+  }
+  array.Emplace(0, new int32_t(-1));  // -1, 0, 1, 2, 3, 4, 5
+  EXPECT_EQ(*array.Remove(3), 2);     // -1, 0, 1, 3, 4, 5
+  EXPECT_EQ(array.SwapEraseIf([](Owned<int32_t>& num) { return *num < 1; }), 2);
+  EXPECT_EQ(array.Size(), 4);
+  int32_t sum = 0;
+  for (auto& num : array) {
+    sum += *num;
+  }
+  EXPECT_EQ(sum, 13);
+
+  Owned<int32_t> items[] = {Owned<int32_t>::New(7), Owned<int32_t>::New(8)};
+  EXPECT_THROW(array.Append(std::span<const Owned<int32_t>>(items)),
+               std::invalid_argument);
+  array.Append(std::make_move_iterator(std::begin(items)),
+               std::make_move_iterator(std::end(items)));
+  EXPECT_TRUE(items[0].IsNull());
+  EXPECT_EQ(*array[5], 8);
+}
+
+TEST(ArrayTests, ShiftNonTrivial) {
+  Array<std::string> array = {"b", "d"};
+  array.Insert(0, std::string("a"));
+  array.Insert(2, std::string("c"));
+  array.Emplace(4, 1, 'e');
+  EXPECT_EQ(array, (Array<std::string>{"a", "b", "c", "d", "e"}));
+  EXPECT_EQ(array.Remove(1), "b");
+  array.EraseRange(0, 2);
+  EXPECT_EQ(array, (Array<std::string>{"d", "e"}));
+}
+
+template <typename T>
+void ExpectSearch() {
+  Array<T> array;
+  for (int32_t i = 0; i < 100; ++i) {
+    array.PushBack(static_cast<T>(i % 50));
+  }
+  for (int32_t i = 0; i < 50; ++i) {
+    auto val = static_cast<T>(i);
+    EXPECT_EQ(array.IndexOf(val), i);
+    EXPECT_EQ(array.Count(val), 2);
+    EXPECT_EQ(*array.Find(val), val);
+  }
+  EXPECT_FALSE(array.Contains(static_cast<T>(50)));
+  EXPECT_EQ(array.Find(static_cast<T>(50)), array.end());
+  EXPECT_EQ(array.IndexOf(static_cast<T>(50)), std::nullopt);
+
+  Array<T> other = array;
+  EXPECT_EQ(array, other);
+  other[99] = static_cast<T>(0);
+  EXPECT_FALSE(array == other);
+}
+
+TEST(ArrayTests, SearchBitwise) {
+  enum class Id : uint16_t {};
+  ExpectSearch<uint8_t>();
+  ExpectSearch<Id>();
+  ExpectSearch<int32_t>();
+  ExpectSearch<uint64_t>();
+  ExpectSearch<float>();
+  EXPECT_TRUE(kBitwiseSearchable<uint32_t>);
+  EXPECT_FALSE(kBitwiseSearchable<double>);
+
+  // Lanes whose low halves match must not count as 64-bit matches.
+  Array<uint64_t> wide = {1ull << 32, 1, 1ull << 33, 1};
+  EXPECT_EQ(wide.Count(1), 2);
+  EXPECT_EQ(wide.IndexOf(1ull << 33), 2);
+}
+
+TEST(ArrayTests, SearchScalar) {
+  Array<std::string> array = {"a", "b", "a"};
+  EXPECT_EQ(array.Count("a"), 2);
+  EXPECT_EQ(array.IndexOf("b"), 1);
+  EXPECT_FALSE(array.Contains("c"));
+}
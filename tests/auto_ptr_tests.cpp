@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <concepts>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
 #include "pigeon_framework/base/auto_ptr/owned.hpp"
 #include "pigeon_framework/base/auto_ptr/shared.hpp"
 #include "pigeon_framework/base/auto_ptr/unretained.hpp"
+#include "pigeon_framework/task/task.hpp"
 
 using namespace pigeon;
 
@@ -11,7 +18,9 @@ TEST(AutoPtrTests, CustomDestructor) {
     auto custom_destructor = [](int32_t* cnt) {
       (*cnt)++;
     };
-    auto owned_ptr = Owned<int32_t>(&destruct_cnt, custom_destructor);
+    auto owned_ptr =
+        Owned<int32_t, decltype(custom_destructor)>(&destruct_cnt,
+                                                    custom_destructor);
     auto shared_ptr = SharedLocal<int32_t>(&destruct_cnt, custom_destructor);
     auto shared_ptr_clone = shared_ptr.Clone();
     EXPECT_EQ(shared_ptr.RefCnt(), 2);
@@ -37,3 +46,142 @@ TEST(AutoPtrTests, UpgradeUnretained) {
   retained = unretained.TryUpgrade();
   EXPECT_TRUE(retained.IsNull());
 }
+
+TEST(AutoPtrTests, OwnedLayout) {
+  struct Base {
+    virtual ~Base() = default;
+  };
+  struct Derived : public Base {
+    explicit Derived(Owned<int32_t>&& num) : num_(std::move(num)) {}
+    Owned<int32_t> num_;
+  };
+
+  EXPECT_EQ(sizeof(Owned<int32_t>), sizeof(void*));
+  EXPECT_TRUE(kTriviallyRelocatable<Owned<int32_t>>);
+
+  Owned<Base> base = Owned<Derived>::New(Owned<int32_t>::New(1));
+  EXPECT_EQ(*static_cast<Derived*>(base.Get())->num_, 1);
+}
+
+TEST(AutoPtrTests, SharedBlockLayout) {
+  EXPECT_EQ(sizeof(SharedAsync<int32_t>), 2 * sizeof(void*));
+  EXPECT_EQ(sizeof(UnretainedAsync<int32_t>), 2 * sizeof(void*));
+
+  int32_t destruct_cnt = 0;
+  struct Value {
+    explicit Value(int32_t* cnt) : cnt_(cnt) {}
+    ~Value() { (*cnt_)++; }
+    int32_t* cnt_;
+  };
+
+  UnretainedLocal<Value> unretained;
+  {
+    auto shared = SharedLocal<Value>::New(&destruct_cnt);
+    unretained = UnretainedLocal<Value>(shared);
+    EXPECT_EQ(unretained.Get(), shared.Get());
+  }
+  EXPECT_EQ(destruct_cnt, 1);
+  EXPECT_TRUE(unretained.IsNull());
+  EXPECT_TRUE(unretained.TryUpgrade().IsNull());
+}
+
+TEST(AutoPtrTests, SharedAsyncAcrossThreads) {
+  static_assert(!std::is_polymorphic_v<ThreadSafeRefCount>);
+  static_assert(!std::is_polymorphic_v<ThreadLocalRefCount>);
+
+  std::atomic_int32_t destruct_cnt = 0;
+  auto destructor = [&destruct_cnt](int32_t* ptr) {
+    delete ptr;
+    destruct_cnt += 1;
+  };
+
+  auto shared = SharedAsync<int32_t>(new int32_t(0), destructor);
+  auto unretained = UnretainedAsync<int32_t>(shared);
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&shared, &unretained] {
+      for (int32_t j = 0; j < 10000; ++j) {
+        auto cloned = shared.Clone();
+        auto upgraded = unretained.TryUpgrade();
+        EXPECT_FALSE(upgraded.IsNull());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(shared.RefCnt(), 1);
+  shared = SharedAsync<int32_t>();
+  EXPECT_EQ(destruct_cnt, 1);
+  EXPECT_TRUE(unretained.TryUpgrade().IsNull());
+}
+
+namespace {
+
+class Service : public RefCounted<ThreadSafeRefCount> {
+ public:
+  explicit Service(int32_t* destruct_cnt) : destruct_cnt_(destruct_cnt) {}
+
+  virtual ~Service() { (*destruct_cnt_)++; }
+
+  SharedAsync<Service> Self() { return SharedAsync<Service>::Share(this); }
+
+ private:
+  int32_t* destruct_cnt_;
+};
+
+// Allocated by Task::operator new from the task arena.
+class CountedTask : public Task, public RefCounted<ThreadSafeRefCount> {
+ public:
+  Status Execute() override { return Done; }
+};
+
+}  // namespace
+
+TEST(AutoPtrTests, IntrusiveRefCount) {
+  EXPECT_EQ(sizeof(SharedAsync<Service>), sizeof(void*));
+  EXPECT_EQ(sizeof(UnretainedAsync<Service>), sizeof(void*));
+
+  int32_t destruct_cnt = 0;
+  UnretainedAsync<Service> unretained;
+  {
+    auto shared = SharedAsync<Service>::New(&destruct_cnt);
+    auto self = shared->Self();
+    EXPECT_EQ(self.Get(), shared.Get());
+    EXPECT_EQ(shared.RefCnt(), 2);
+
+    unretained = UnretainedAsync<Service>(shared);
+    EXPECT_EQ(shared.UnretainedRefCnt(), 1);
+    auto upgraded = unretained.TryUpgrade();
+    EXPECT_EQ(upgraded.RefCnt(), 3);
+  }
+  EXPECT_EQ(destruct_cnt, 1);
+  EXPECT_TRUE(unretained.IsNull());
+  EXPECT_TRUE(unretained.TryUpgrade().IsNull());
+
+  auto adopted = SharedAsync<Service>(new Service(&destruct_cnt));
+  EXPECT_EQ(adopted.RefCnt(), 1);
+  adopted = SharedAsync<Service>();
+  EXPECT_EQ(destruct_cnt, 2);
+}
+
+TEST(AutoPtrTests, IntrusiveOwnOperatorNew) {
+  auto task = SharedAsync<CountedTask>::New();
+  CountedTask* raw_ptr = task.Get();
+  UnretainedAsync<CountedTask> unretained(task);
+  task = SharedAsync<CountedTask>();
+  unretained = UnretainedAsync<CountedTask>();
+
+  // The memory went back to the arena and is handed out again.
+  task = SharedAsync<CountedTask>::New();
+  EXPECT_EQ(task.Get(), raw_ptr);
+  EXPECT_EQ(SharedAsync<CountedTask>::Share(task.Get()).RefCnt(), 2);
+  // Task::operator delete needs the size of the real object, so raw pointers
+  // are not adopted.
+  static_assert(!std::constructible_from<SharedAsync<CountedTask>,
+                                         CountedTask*>);
+  static_assert(std::constructible_from<SharedAsync<Service>, Service*>);
+  CountedTask unowned;
+  EXPECT_THROW(SharedAsync<CountedTask>::Share(&unowned),
+               std::invalid_argument);
+}
@@ -0,0 +1,31 @@
+#ifndef PIGEON_FRAMEWORK_TESTS_COUNTING_RESOURCE
+#define PIGEON_FRAMEWORK_TESTS_COUNTING_RESOURCE
+
+#include <cstddef>
+#include "pigeon_framework/base/memory/allocator.hpp"
+
+namespace pigeon {
+
+// Heap resource that counts what goes through it.
+class CountingResource : public MemoryResource {
+ public:
+  void* Allocate(size_t size, size_t align) override {
+    ++alloc_cnt_;
+    live_bytes_ += size;
+    return MemoryResource::Heap()->Allocate(size, align);
+  }
+
+  void Deallocate(void* ptr, size_t size, size_t align) override {
+    ++free_cnt_;
+    live_bytes_ -= size;
+    MemoryResource::Heap()->Deallocate(ptr, size, align);
+  }
+
+  size_t alloc_cnt_{0};
+  size_t free_cnt_{0};
+  size_t live_bytes_{0};
+};
+
+}  // namespace pigeon
+
+#endif  // PIGEON_FRAMEWORK_TESTS_COUNTING_RESOURCE
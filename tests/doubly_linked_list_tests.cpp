@@ -1,4 +1,199 @@
 #include <gtest/gtest.h>
+#include <stdint.h>
+#include <iterator>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/array.hpp"
 #include "pigeon_framework/base/container/doubly_linked_list.hpp"
+#include "counting_resource.hpp"
 
 using namespace pigeon;
+
+namespace {
+
+static_assert(std::bidirectional_iterator<DoublyLinkedListIterator<int32_t>>);
+static_assert(
+    std::bidirectional_iterator<DoublyLinkedListConstIterator<int32_t>>);
+
+template <typename T, typename A>
+Array<T> ToArray(const DoublyLinkedList<T, A>& list) {
+  Array<T> array;
+  for (const T& item : list) {
+    array.PushBack(item);
+  }
+  return array;
+}
+
+struct LruTag {};
+struct DirtyTag {};
+
+struct Entry : public ListHook<LruTag>, public ListHook<DirtyTag> {
+  explicit Entry(int32_t key) : key_(key) {}
+
+  int32_t key_;
+};
+
+using LruList = IntrusiveList<Entry, LruTag>;
+using DirtyList = IntrusiveList<Entry, DirtyTag>;
+
+}  // namespace
+
+TEST(DoublyLinkedListTests, Basic) {
+  DoublyLinkedList<int32_t> list{1, 2, 3};
+  list.PushFront(0);
+  list.PushBack(4);
+  EXPECT_EQ(list.Size(), 5);
+  EXPECT_EQ(list.Front(), 0);
+  EXPECT_EQ(list.Back(), 4);
+  EXPECT_EQ(ToArray(list), (Array<int32_t>{0, 1, 2, 3, 4}));
+
+  auto it = std::next(list.begin(), 2);
+  it = list.Erase(it);
+  EXPECT_EQ(*it, 3);
+  list.Insert(it, 7);
+  EXPECT_EQ(ToArray(list), (Array<int32_t>{0, 1, 7, 3, 4}));
+
+  EXPECT_EQ(list.PopFront(), 0);
+  EXPECT_EQ(list.PopBack(), 4);
+  EXPECT_EQ(list.EraseIf([](int32_t item) { return item % 2 == 1; }), 3);
+  EXPECT_TRUE(list.IsEmpty());
+  EXPECT_THROW(list.PopBack(), std::out_of_range);
+  EXPECT_THROW(list.Erase(list.end()), std::out_of_range);
+
+  DoublyLinkedList<int32_t> copied{5, 6};
+  list = copied;
+  EXPECT_EQ(list, copied);
+  DoublyLinkedList<int32_t> moved(std::move(copied));
+  EXPECT_TRUE(copied.IsEmpty());
+  EXPECT_EQ(list, moved);
+  EXPECT_EQ(*--moved.end(), 6);
+}
+
+TEST(DoublyLinkedListTests, MoveOnly) {
+  DoublyLinkedList<Owned<int32_t>> list;
+  list.PushBack(Owned<int32_t>::New(1));
+  list.EmplaceFront(Owned<int32_t>::New(0));
+  EXPECT_THROW(list.Insert(list.end(), list.Front()), std::invalid_argument);
+  EXPECT_EQ(*list.PopFront(), 0);
+  EXPECT_EQ(*list.PopBack(), 1);
+}
+
+TEST(DoublyLinkedListTests, Splice) {
+  DoublyLinkedList<int32_t> first{0, 1, 2};
+  DoublyLinkedList<int32_t> second{3, 4, 5};
+  auto stable = second.begin();
+
+  first.Splice(first.end(), second);
+  EXPECT_TRUE(second.IsEmpty());
+  EXPECT_EQ(first.Size(), 6);
+  EXPECT_EQ(*stable, 3);
+
+  first.MoveToFront(stable);
+  EXPECT_EQ(ToArray(first), (Array<int32_t>{3, 0, 1, 2, 4, 5}));
+  first.MoveToBack(first.begin());
+  EXPECT_EQ(ToArray(first), (Array<int32_t>{0, 1, 2, 4, 5, 3}));
+
+  second.Splice(second.end(), first, std::next(first.begin()),
+                std::prev(first.end()));
+  EXPECT_EQ(ToArray(first), (Array<int32_t>{0, 3}));
+  EXPECT_EQ(ToArray(second), (Array<int32_t>{1, 2, 4, 5}));
+
+  second.Splice(second.begin(), second, std::next(second.begin(), 2),
+                second.end());
+  EXPECT_EQ(ToArray(second), (Array<int32_t>{4, 5, 1, 2}));
+  second.Splice(second.begin(), first, --first.end());
+  EXPECT_EQ(first.Size(), 1);
+  EXPECT_EQ(second.Size(), 5);
+  EXPECT_EQ(*stable, 3);
+  EXPECT_EQ(second.Front(), 3);
+}
+
+TEST(DoublyLinkedListTests, SpliceInPlace) {
+  DoublyLinkedList<int32_t> list{1, 2, 3};
+  list.MoveToFront(list.begin());
+  list.MoveToBack(std::prev(list.end()));
+  EXPECT_EQ(ToArray(list), (Array<int32_t>{1, 2, 3}));
+
+  // Ranges that start at or end right before `pos` stay where they are.
+  list.Splice(list.begin(), list, list.begin(), list.end());
+  list.Splice(list.end(), list, list.begin(), list.end());
+  auto second = std::next(list.begin());
+  list.Splice(second, list, second);
+  list.Splice(second, list, list.begin());
+  EXPECT_EQ(ToArray(list), (Array<int32_t>{1, 2, 3}));
+  EXPECT_EQ(*std::prev(list.end()), 3);
+
+  list.MoveToBack(list.begin());
+  list.MoveToFront(std::prev(list.end()));
+  EXPECT_EQ(ToArray(list), (Array<int32_t>{1, 2, 3}));
+  EXPECT_EQ(list.Size(), 3);
+}
+
+TEST(DoublyLinkedListTests, NodePool) {
+  CountingResource resource;
+  {
+    DoublyLinkedList<int32_t, ResourceAllocator> list(&resource);
+    list.Reserve(4);
+    EXPECT_EQ(resource.alloc_cnt_, 4);
+    for (int32_t round = 0; round < 8; ++round) {
+      for (int32_t i = 0; i < 4; ++i) {
+        list.PushBack(i);
+      }
+      list.Clear();
+    }
+    EXPECT_EQ(resource.alloc_cnt_, 4);
+    EXPECT_EQ(resource.free_cnt_, 0);
+    EXPECT_EQ(list.Capacity(), 4);
+
+    CountingResource other;
+    DoublyLinkedList<int32_t, ResourceAllocator> foreign(&other);
+    foreign.PushBack(0);
+    EXPECT_THROW(list.Splice(list.end(), foreign), std::invalid_argument);
+
+    list.ShrinkToFit();
+    EXPECT_EQ(resource.free_cnt_, 4);
+  }
+  EXPECT_EQ(resource.alloc_cnt_, resource.free_cnt_);
+}
+
+TEST(DoublyLinkedListTests, Intrusive) {
+  Entry entries[] = {Entry(0), Entry(1), Entry(2), Entry(3)};
+  LruList lru;
+  DirtyList dirty;
+  for (Entry& entry : entries) {
+    lru.PushBack(entry);
+  }
+  dirty.PushBack(entries[2]);
+  EXPECT_THROW(lru.PushBack(entries[0]), std::invalid_argument);
+
+  // Touching an entry makes it the most recently used one.
+  lru.MoveToBack(entries[1]);
+  lru.MoveToBack(entries[0]);
+  EXPECT_EQ(lru.Front().key_, 2);
+  Entry& evicted = lru.PopFront();
+  EXPECT_EQ(evicted.key_, 2);
+  EXPECT_FALSE(LruList::IsLinked(evicted));
+  EXPECT_TRUE(DirtyList::IsLinked(evicted));
+  dirty.Remove(evicted);
+
+  Array<int32_t> keys;
+  for (const Entry& entry : lru) {
+    keys.PushBack(entry.key_);
+  }
+  EXPECT_EQ(keys, (Array<int32_t>{3, 1, 0}));
+
+  // Touching the entries already at either end changes nothing.
+  lru.MoveToFront(entries[3]);
+  lru.MoveToBack(entries[0]);
+  keys.Clear();
+  for (const Entry& entry : lru) {
+    keys.PushBack(entry.key_);
+  }
+  EXPECT_EQ(keys, (Array<int32_t>{3, 1, 0}));
+
+  LruList other;
+  other.Splice(other.end(), lru, lru.IteratorTo(entries[1]));
+  EXPECT_EQ(lru.Size(), 2);
+  EXPECT_EQ(other.Size(), 1);
+  lru.Clear();
+  EXPECT_FALSE(LruList::IsLinked(entries[3]));
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <thread>
+#include "pigeon_framework/application.hpp"
+#include "pigeon_framework/base/memory/frame_arena.hpp"
+
+using namespace pigeon;
+
+TEST(FrameArenaTests, Allocate) {
+  FrameArena::NextFrame();
+  auto* small = static_cast<std::byte*>(FrameArena::Allocate(3, 1));
+  void* aligned = FrameArena::Allocate(64, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+  EXPECT_EQ(FrameArena::UsedBytes(), 67);
+
+  // Only the latest allocation can be given back.
+  FrameArena::Deallocate(small, 3);
+  EXPECT_EQ(FrameArena::UsedBytes(), 67);
+  FrameArena::Deallocate(aligned, 64);
+  EXPECT_EQ(FrameArena::UsedBytes(), 3);
+
+  void* large = FrameArena::Allocate(2 * FrameArena::kChunkSize, 16);
+  EXPECT_NE(large, nullptr);
+  EXPECT_GE(FrameArena::ReservedBytes(), 2 * FrameArena::kChunkSize);
+}
+
+TEST(FrameArenaTests, DoubleBuffered) {
+  FrameArena::NextFrame();
+  FrameArray<int32_t> previous;
+  for (int32_t i = 0; i < 100; ++i) {
+    previous.PushBack(i);
+  }
+  void* first = FrameArena::Allocate(8, 8);
+
+  // Still intact one frame later.
+  FrameArena::NextFrame();
+  FrameArray<int32_t> current{-1, -2};
+  EXPECT_EQ(previous[99], 99);
+  EXPECT_NE(FrameArena::Allocate(8, 8), first);
+
+  // Two frames later the first buffer starts over.
+  FrameArena::NextFrame();
+  EXPECT_EQ(FrameArena::UsedBytes(), 0);
+  FrameArena::Allocate(previous.Capacity() * sizeof(int32_t), 4);
+  EXPECT_EQ(previous.Get()[0], 0);
+}
+
+TEST(FrameArenaTests, SteadyState) {
+  for (int32_t frame = 0; frame < 4; ++frame) {
+    FrameArena::NextFrame();
+    for (int32_t i = 0; i < 1000; ++i) {
+      FrameArena::Allocate(1024, 16);
+    }
+  }
+  size_t reserved = FrameArena::ReservedBytes();
+  for (int32_t frame = 0; frame < 10; ++frame) {
+    FrameArena::NextFrame();
+    for (int32_t i = 0; i < 1000; ++i) {
+      FrameArena::Allocate(1024, 16);
+    }
+  }
+  EXPECT_EQ(FrameArena::ReservedBytes(), reserved);
+}
+
+TEST(FrameArenaTests, PerThread) {
+  FrameArena::NextFrame();
+  FrameArena::Allocate(100, 8);
+  size_t other_used = 1;
+  std::thread thread([&other_used] {
+    FrameArena::Allocate(10, 8);
+    other_used = FrameArena::UsedBytes();
+  });
+  thread.join();
+  EXPECT_EQ(other_used, 10);
+  EXPECT_EQ(FrameArena::UsedBytes(), 100);
+}
+
+TEST(FrameArenaTests, ApplicationAdvancesFrames) {
+  {
+    Application app;
+    uint64_t frame = FrameArena::Frame();
+    app.Tick(Application::Clock::now());
+    EXPECT_EQ(FrameArena::Frame(), frame + 1);
+    // A second one would reset the buffers during the first one's frames.
+    EXPECT_THROW(Application(), std::invalid_argument);
+  }
+  Application next;
+  next.Tick(Application::Clock::now());
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/hash_map.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+// Sends every key into the same group, so probing has to go past it.
+struct CollidingHash {
+  size_t operator()(int32_t key) const { return key % 2; }
+};
+
+}  // namespace
+
+TEST(HashMapTests, Basic) {
+  HashMap<int32_t, int32_t> map{{1, 10}, {2, 20}};
+  EXPECT_EQ(map.Size(), 2);
+  EXPECT_TRUE(map.Insert(3, 30));
+  EXPECT_FALSE(map.Insert(3, 31));
+  EXPECT_EQ(map.At(3), 30);
+  EXPECT_FALSE(map.InsertOrAssign(3, 32));
+  EXPECT_EQ(map.At(3), 32);
+  map[4] += 40;
+  EXPECT_EQ(map[4], 40);
+
+  EXPECT_TRUE(map.Contains(1));
+  EXPECT_EQ(map.Find(5), map.end());
+  EXPECT_THROW(map.At(5), std::out_of_range);
+  EXPECT_EQ(map.Remove(1), 10);
+  EXPECT_EQ(map.Remove(1), std::nullopt);
+  EXPECT_TRUE(map.Erase(2));
+  EXPECT_FALSE(map.Erase(2));
+
+  int32_t sum = 0;
+  for (const auto& item : map) {
+    sum += item.key_ * 100 + item.value_;
+  }
+  EXPECT_EQ(sum, 300 + 32 + 400 + 40);
+
+  HashMap<int32_t, int32_t> copied = map;
+  map.Erase(map.Find(3));
+  EXPECT_EQ(copied.Size(), 2);
+  HashMap<int32_t, int32_t> moved(std::move(copied));
+  EXPECT_TRUE(copied.IsEmpty());
+  EXPECT_EQ(moved.At(3), 32);
+  map.Clear();
+  EXPECT_EQ(map.Capacity(), 0);
+}
+
+TEST(HashMapTests, MatchesStdUnorderedMap) {
+  HashMap<int32_t, int32_t> map;
+  std::unordered_map<int32_t, int32_t> expected;
+  uint32_t seed = 7;
+  for (int32_t i = 0; i < 20000; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    int32_t key = static_cast<int32_t>(seed >> 20);
+    if (seed & 0x10) {
+      map.InsertOrAssign(key, i);
+      expected[key] = i;
+    } else {
+      EXPECT_EQ(map.Erase(key), expected.erase(key) == 1);
+    }
+  }
+  EXPECT_EQ(map.Size(), expected.size());
+  for (const auto& [key, val] : expected) {
+    EXPECT_EQ(map.At(key), val);
+  }
+  EXPECT_EQ(map.EraseIf([](auto& item) { return item.key_ % 3 == 0; }),
+            std::erase_if(expected,
+                          [](auto& item) { return item.first % 3 == 0; }));
+  EXPECT_EQ(map.Size(), expected.size());
+}
+
+TEST(HashMapTests, Collisions) {
+  HashMap<int32_t, int32_t, CollidingHash> map;
+  for (int32_t i = 0; i < 100; ++i) {
+    map.Insert(i, -i);
+  }
+  for (int32_t i = 0; i < 100; i += 2) {
+    map.Erase(i);
+  }
+  for (int32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(map.Contains(i), i % 2 == 1);
+  }
+  EXPECT_EQ(map.At(99), -99);
+}
+
+TEST(HashMapTests, Reserve) {
+  HashMap<int32_t, Owned<int32_t>> map;
+  map.Reserve(1000);
+  size_t capacity = map.Capacity();
+  EXPECT_GE(capacity, 1000);
+  for (int32_t i = 0; i < 1000; ++i) {
+    map.Emplace(i, Owned<int32_t>::New(i));
+  }
+  EXPECT_EQ(map.Capacity(), capacity);
+  EXPECT_EQ(*map.At(500), 500);
+  EXPECT_EQ(*map.Remove(500).value(), 500);
+  using OwnedMap = HashMap<int32_t, Owned<int32_t>>;
+  EXPECT_THROW(OwnedMap{map}, std::invalid_argument);
+}
+
+TEST(HashMapTests, EmplaceAliasWhileGrowing) {
+  // Long enough to live on the heap, so a dangling copy is caught.
+  const std::string first(64, 'a');
+  HashMap<std::string, std::string> map;
+  HashSet<std::string> set;
+  map.Emplace(first, first);
+  set.Emplace(first);
+  size_t map_growths = 0;
+  size_t set_growths = 0;
+  for (int32_t i = 0; map_growths < 2 || set_growths < 2; ++i) {
+    std::string key = std::to_string(i) + first;
+    size_t capacity = map.Capacity();
+    map.Emplace(std::string_view(key), map.At(first));
+    map_growths += map.Capacity() != capacity;
+    capacity = set.Capacity();
+    set.Emplace(std::string_view(key));
+    // A new key viewing into an element of the set.
+    std::string_view inside(*set.Find(key));
+    set.Emplace(inside.substr(0, inside.size() - 1));
+    set_growths += set.Capacity() != capacity;
+    EXPECT_TRUE(set.Contains(key.substr(0, key.size() - 1)));
+  }
+  for (const auto& item : map) {
+    EXPECT_EQ(item.value_, first);
+  }
+  EXPECT_EQ(set.Size(), 2 * map.Size() - 1);
+}
+
+TEST(HashMapTests, MixedNumericKeys) {
+  // Equal numbers of different types hash differently, so they are converted
+  // to the key type instead of being looked up as they are.
+  using Map = HashMap<int64_t, int32_t>;
+  static_assert(!Map::kLookup<double> && Map::kFind<double>);
+  static_assert(!Map::kLookup<int32_t> && Map::kLookup<int64_t>);
+
+  Map map;
+  map.Emplace(1, 10);
+  EXPECT_TRUE(map.Contains(1.0));
+  EXPECT_EQ(map.At(int8_t{1}), 10);
+  EXPECT_FALSE(map.Emplace(1.0, 20).second);
+  EXPECT_EQ(map.Size(), 1);
+
+  HashSet<int64_t> set{7};
+  EXPECT_FALSE(set.Emplace(7.0).second);
+  EXPECT_TRUE(set.Erase(7u));
+  EXPECT_TRUE(set.IsEmpty());
+}
+
+TEST(HashMapTests, HeterogeneousLookup) {
+  HashMap<std::string, int32_t> map;
+  map.Emplace("player", 1);
+  map.Emplace(std::string_view("enemy"), 2);
+  EXPECT_EQ(map.At("player"), 1);
+  EXPECT_EQ(map.At(std::string_view("enemy")), 2);
+  EXPECT_TRUE(map.Contains(std::string("enemy")));
+  EXPECT_FALSE(map.Emplace("player", 3).second);
+
+  HashSet<std::string> set{"mesh", "texture"};
+  EXPECT_TRUE(set.Contains("mesh"));
+  EXPECT_FALSE(set.Insert("mesh"));
+  EXPECT_TRUE(set.Erase(std::string_view("texture")));
+  EXPECT_EQ(set.Size(), 1);
+  EXPECT_EQ(*set.begin(), "mesh");
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include "pigeon_framework/application.hpp"
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/auto_ptr/shared.hpp"
+#include "pigeon_framework/base/container/array.hpp"
+#include "pigeon_framework/base/memory/memory_tracker.hpp"
+
+using namespace pigeon;
+using namespace std::chrono_literals;
+
+namespace {
+
+// A per-frame task whose scratch array is reused, so steady frames never
+// allocate.
+class ScratchTask : public Task {
+ public:
+  Status Execute() override {
+    scratch_.Resize(0);
+    for (int32_t i = 0; i < 64; ++i) {
+      scratch_.PushBack(i);
+    }
+    return Keep;
+  }
+
+ private:
+  Array<int32_t> scratch_;
+};
+
+struct RefCountedValue : public RefCounted<ThreadSafeRefCount> {
+  int64_t value_{0};
+};
+
+struct alignas(64) AlignedValue {
+  int64_t value_{0};
+};
+
+}  // namespace
+
+TEST(MemoryTrackerTests, Tags) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.Tags");
+  EXPECT_STREQ(MemoryTracker::Stats(tag).name_, "Tests.Tags");
+  EXPECT_STREQ(MemoryTracker::Stats(kMemoryTagTasks).name_, "Tasks");
+  EXPECT_THROW(MemoryTracker::Stats(MemoryTracker::kMaxTagCnt - 1),
+               std::out_of_range);
+
+  EXPECT_EQ(MemoryTracker::CurrentTag(), kMemoryTagGeneral);
+  {
+    MemoryTagScope scope(tag);
+    EXPECT_EQ(MemoryTracker::CurrentTag(), tag);
+    MemoryTagScope inner(kMemoryTagTimers);
+    EXPECT_EQ(MemoryTracker::CurrentTag(), kMemoryTagTimers);
+  }
+  EXPECT_EQ(MemoryTracker::CurrentTag(), kMemoryTagGeneral);
+  EXPECT_THROW(MemoryTagScope(MemoryTracker::kMaxTagCnt), std::out_of_range);
+  EXPECT_THROW(MemoryTracker::OnAllocate(UINT8_MAX, 1), std::out_of_range);
+  EXPECT_EQ(MemoryTracker::CurrentTag(), kMemoryTagGeneral);
+  EXPECT_NE(MemoryTracker::Dump().find("Tests.Tags"), std::string::npos);
+}
+
+TEST(MemoryTrackerTests, TrackedAllocate) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.Tracked");
+  void* ptr;
+  void* aligned;
+  {
+    MemoryTagScope scope(tag);
+    ptr = TrackedAllocate(100, 8);
+    aligned = TrackedAllocate(64, 64);
+  }
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+  MemoryStats stats = MemoryTracker::Stats(tag);
+  EXPECT_EQ(stats.live_bytes_, 164);
+  EXPECT_EQ(stats.alloc_cnt_, 2);
+
+  // Charged back to the allocating tag wherever it is freed.
+  TrackedDeallocate(ptr, 100, 8);
+  TrackedDeallocate(aligned, 64, 64);
+  stats = MemoryTracker::Stats(tag);
+  EXPECT_EQ(stats.live_bytes_, 0);
+  EXPECT_EQ(stats.peak_bytes_, 164);
+  EXPECT_EQ(stats.free_cnt_, 2);
+
+  // A large enough peak is kept even if it is never seen by a read.
+  constexpr size_t kSize = MemoryTracker::kPeakSlack;
+  {
+    MemoryTagScope scope(tag);
+    ptr = TrackedAllocate(kSize, 8);
+  }
+  TrackedDeallocate(ptr, kSize, 8);
+  EXPECT_EQ(MemoryTracker::Stats(tag).peak_bytes_, kSize);
+}
+
+TEST(MemoryTrackerTests, Threads) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.Threads");
+  void* ptrs[4];
+  std::thread threads[4];
+  for (int32_t i = 0; i < 4; ++i) {
+    threads[i] = std::thread([&ptrs, i] {
+      MemoryTagScope scope(tag);
+      ptrs[i] = TrackedAllocate(10, 8);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // Counters of exited threads are kept.
+  EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_, 40);
+  for (void* ptr : ptrs) {
+    TrackedDeallocate(ptr, 10, 8);
+  }
+  EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_, 0);
+  EXPECT_EQ(MemoryTracker::Stats(tag).alloc_cnt_, 4);
+}
+
+#if defined(PIGEON_TRACK_MEMORY)
+TEST(MemoryTrackerTests, HeapAllocator) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.Heap");
+  {
+    MemoryTagScope scope(tag);
+    Array<int64_t> array;
+    array.Reserve(16);
+    auto owned = Owned<int64_t>::NewIn(HeapAllocator(), 1);
+    EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_,
+              16 * sizeof(int64_t) + sizeof(int64_t));
+    auto shared = SharedAsync<int64_t>::New(1);
+    EXPECT_EQ(MemoryTracker::Stats(tag).alloc_cnt_, 3);
+    auto ref_counted = SharedAsync<RefCountedValue>::New();
+    EXPECT_EQ(MemoryTracker::Stats(tag).alloc_cnt_, 4);
+  }
+  EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_, 0);
+  EXPECT_EQ(MemoryTracker::Stats(tag).free_cnt_, 4);
+}
+
+TEST(MemoryTrackerTests, PlainNew) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.PlainNew");
+  {
+    MemoryTagScope scope(tag);
+    auto owned = Owned<int64_t>::New(1);
+    SharedAsync<int64_t> adopted(new int64_t(2));
+    auto* aligned = new AlignedValue();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+    // The adopted pointer brings its control block.
+    EXPECT_EQ(MemoryTracker::Stats(tag).alloc_cnt_, 4);
+    delete aligned;
+  }
+  EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_, 0);
+  EXPECT_EQ(MemoryTracker::Stats(tag).free_cnt_, 4);
+}
+
+TEST(MemoryTrackerTests, SteadyTickAllocatesNothing) {
+  Application app;
+  for (int32_t i = 0; i < 8; ++i) {
+    app.PushFrame(Owned<ScratchTask>::New());
+  }
+  auto now = Application::Clock::now();
+  // Warm-up frames grow the arrays.
+  for (int32_t i = 0; i < 3; ++i) {
+    app.Tick(now + i * 16ms);
+  }
+  for (int32_t i = 3; i < 10; ++i) {
+    app.Tick(now + i * 16ms);
+    EXPECT_EQ(app.TickAllocCnt(), 0);
+  }
+  EXPECT_GT(app.GetMemoryStats(kMemoryTagTasks).live_bytes_, 0);
+}
+#endif
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/base/container/mpsc_queue.hpp"
+#include "pigeon_framework/task/task_inbox.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+struct Item : public MpscNode {
+  Item(int32_t producer, int32_t seq) : producer_(producer), seq_(seq) {}
+
+  int32_t producer_;
+  int32_t seq_;
+};
+
+class CountTask : public Task {
+ public:
+  explicit CountTask(std::atomic_int32_t* destroyed) : destroyed_(destroyed) {}
+  ~CountTask() override { ++*destroyed_; }
+
+  Status Execute() override { return Status::Done; }
+
+ private:
+  std::atomic_int32_t* destroyed_;
+};
+
+}  // namespace
+
+TEST(MpscQueueTests, SingleThread) {
+  MpscQueue<Item> queue;
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.Pop(), nullptr);
+  Item first(0, 0);
+  Item second(0, 1);
+  queue.Push(&first);
+  EXPECT_FALSE(queue.IsEmpty());
+  queue.Push(&second);
+  EXPECT_EQ(queue.Pop(), &first);
+  EXPECT_EQ(queue.Pop(), &second);
+  EXPECT_EQ(queue.Pop(), nullptr);
+  EXPECT_TRUE(queue.IsEmpty());
+
+  // Items may be pushed again once popped.
+  queue.Push(&second);
+  queue.Push(&first);
+  EXPECT_EQ(queue.Pop(), &second);
+  EXPECT_EQ(queue.Pop(), &first);
+  EXPECT_EQ(queue.Pop(), nullptr);
+}
+
+TEST(MpscQueueTests, Producers) {
+  constexpr int32_t kProducerCnt = 4;
+  constexpr int32_t kItemCnt = 20000;
+  std::vector<Item> items;
+  items.reserve(kProducerCnt * kItemCnt);
+  for (int32_t p = 0; p < kProducerCnt; ++p) {
+    for (int32_t i = 0; i < kItemCnt; ++i) {
+      items.emplace_back(p, i);
+    }
+  }
+
+  MpscQueue<Item> queue;
+  std::vector<std::thread> producers;
+  for (int32_t p = 0; p < kProducerCnt; ++p) {
+    producers.emplace_back([&queue, &items, p] {
+      for (int32_t i = 0; i < kItemCnt; ++i) {
+        queue.Push(&items[p * kItemCnt + i]);
+      }
+    });
+  }
+  // Items of each producer come out in the order they were pushed.
+  std::vector<int32_t> next(kProducerCnt, 0);
+  int32_t popped = 0;
+  while (popped < kProducerCnt * kItemCnt) {
+    if (Item* item = queue.Pop()) {
+      EXPECT_EQ(item->seq_, next[item->producer_]++);
+      ++popped;
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(queue.Pop(), nullptr);
+}
+
+TEST(MpscQueueTests, TaskInbox) {
+  std::atomic_int32_t destroyed = 0;
+  {
+    TaskInbox inbox;
+    std::thread([&inbox, &destroyed] {
+      for (int32_t i = 0; i < 10; ++i) {
+        inbox.Post(Owned<CountTask>::New(&destroyed));
+      }
+    }).join();
+    std::vector<Owned<Task>> tasks;
+    auto push = [&tasks](Owned<Task>&& task) {
+      tasks.push_back(std::move(task));
+    };
+    EXPECT_EQ(inbox.Drain(push, 3), 3);
+    EXPECT_EQ(tasks.size(), 3);
+    tasks.clear();
+    EXPECT_EQ(destroyed, 3);
+    inbox.Post(Owned<CountTask>::New(&destroyed));
+  }
+  // Tasks never drained are destroyed with the inbox.
+  EXPECT_EQ(destroyed, 11);
+}
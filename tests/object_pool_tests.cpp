@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/base/auto_ptr/unretained.hpp"
+#include "pigeon_framework/base/memory/object_pool.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+struct Event {
+  Event(int32_t id, int32_t* destroyed) : id_(id), destroyed_(destroyed) {}
+
+  ~Event() { ++*destroyed_; }
+
+  int32_t id_;
+  int32_t* destroyed_;
+};
+
+struct alignas(64) AlignedEvent {
+  int32_t id_;
+};
+
+}  // namespace
+
+TEST(ObjectPoolTests, Owned) {
+  ObjectPool<Event> pool;
+  int32_t destroyed = 0;
+  auto event = pool.New(1, &destroyed);
+  EXPECT_EQ(event->id_, 1);
+  Event* raw_ptr = event.Get();
+  event = pool.New(2, &destroyed);
+  EXPECT_EQ(destroyed, 1);
+
+  // The freed block is the first one handed out again.
+  auto reused = pool.New(3, &destroyed);
+  EXPECT_EQ(reused.Get(), raw_ptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(raw_ptr) % SlabPool::kBlockAlign, 0);
+
+  ObjectPool<AlignedEvent> aligned_pool;
+  auto aligned = aligned_pool.New(AlignedEvent{4});
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned.Get()) % 64, 0);
+}
+
+TEST(ObjectPoolTests, Shared) {
+  ObjectPool<Event> pool;
+  int32_t destroyed = 0;
+  auto local = pool.NewShared<ThreadLocalRefCount>(1, &destroyed);
+  UnretainedLocal<Event> weak(local);
+  SharedAsync<Event> async = pool.NewShared(2, &destroyed);
+  SharedAsync<Event> clone = async.Clone();
+  EXPECT_EQ(clone->id_, 2);
+
+  local = {};
+  EXPECT_EQ(destroyed, 1);
+  EXPECT_TRUE(weak.IsNull());
+  EXPECT_TRUE(weak.TryUpgrade().IsNull());
+  std::thread([&async, &clone] {
+    async = {};
+    clone = {};
+  }).join();
+  EXPECT_EQ(destroyed, 2);
+}
+
+TEST(ObjectPoolTests, SteadyState) {
+  static const MemoryTag tag = MemoryTracker::RegisterTag("Tests.Pool");
+  ObjectPool<Event> pool(tag);
+  EXPECT_EQ(pool.GetAllocator().Pool()->Tag(), tag);
+  pool.Reserve(1000);
+  size_t slab_cnt = pool.GetAllocator().Pool()->SlabCnt();
+  EXPECT_GT(slab_cnt, 0);
+
+  int32_t destroyed = 0;
+  for (int32_t round = 0; round < 10; ++round) {
+    std::vector<ObjectPool<Event>::OwnedType> events;
+    for (int32_t i = 0; i < 1000; ++i) {
+      events.push_back(pool.New(i, &destroyed));
+    }
+    // Half of them die on another thread and come back through the depot.
+    std::thread([&events] { events.resize(500); }).join();
+  }
+  EXPECT_EQ(destroyed, 10000);
+  EXPECT_LE(pool.GetAllocator().Pool()->SlabCnt(), slab_cnt + 1);
+
+  if constexpr (MemoryTracker::kEnabled) {
+    EXPECT_EQ(MemoryTracker::Stats(tag).live_bytes_,
+              pool.GetAllocator().Pool()->SlabCnt() * SlabPool::kSlabSize);
+  }
+}
+
+TEST(ObjectPoolTests, Tags) {
+  EXPECT_EQ(&SlabPool::Get(kMemoryTagTasks), &SlabPool::Get(kMemoryTagTasks));
+  EXPECT_THROW(SlabPool::Get(MemoryTracker::kMaxTagCnt), std::out_of_range);
+  void* large = SlabPool::Get(kMemoryTagGeneral).Allocate(1024);
+  SlabPool::Get(kMemoryTagGeneral).Deallocate(large, 1024);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/profile/profiler.hpp"
+#include "pigeon_framework/task/serial_tasks.hpp"
+#include "pigeon_framework/task/task.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+class NamedTask : public Task {
+ public:
+  Status Execute() override { return Done; }
+};
+
+class LabeledTask : public Task {
+ public:
+  Status Execute() override { return Done; }
+
+  const char* Name() const override { return "Labeled"; }
+};
+
+size_t CountNamed(const Array<ProfileEvent>& events, std::string name) {
+  size_t cnt = 0;
+  for (const ProfileEvent& event : events) {
+    cnt += event.name_ == name;
+  }
+  return cnt;
+}
+
+}  // namespace
+
+TEST(ProfilerTests, Zones) {
+  Profiler::Collect();
+  {
+    ProfileZone outer("outer");
+    ProfileZone inner("inner");
+  }
+  Array<ProfileEvent> events = Profiler::Collect();
+  ASSERT_EQ(events.Size(), 2);
+  EXPECT_STREQ(events[0].name_, "outer");
+  EXPECT_STREQ(events[1].name_, "inner");
+  EXPECT_LE(events[0].begin_ns_, events[1].begin_ns_);
+  EXPECT_GE(events[0].end_ns_, events[1].end_ns_);
+  EXPECT_TRUE(Profiler::Collect().IsEmpty());
+
+  Profiler::SetEnabled(false);
+  { ProfileZone zone("paused"); }
+  Profiler::SetEnabled(true);
+  EXPECT_TRUE(Profiler::Collect().IsEmpty());
+}
+
+TEST(ProfilerTests, Threads) {
+  Profiler::Collect();
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; ++i) {
+    threads.emplace_back([] {
+      for (int32_t j = 0; j < 100; ++j) {
+        ProfileZone zone("worker");
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // The threads are gone, their rings are drained and released.
+  Array<ProfileEvent> events = Profiler::Collect();
+  EXPECT_EQ(CountNamed(events, "worker"), 400);
+  for (size_t i = 1; i < events.Size(); ++i) {
+    EXPECT_LE(events[i - 1].begin_ns_, events[i].begin_ns_);
+  }
+}
+
+TEST(ProfilerTests, DropsWhenFull) {
+  Profiler::Collect();
+  size_t dropped = Profiler::DroppedCnt();
+  for (size_t i = 0; i < Profiler::kRingCapacity + 10; ++i) {
+    Profiler::Record("flood", 0, 1);
+  }
+  EXPECT_EQ(Profiler::DroppedCnt() - dropped, 10);
+  EXPECT_EQ(Profiler::Collect().Size(), Profiler::kRingCapacity);
+}
+
+TEST(ProfilerTests, ChromeTrace) {
+  Array<ProfileEvent> events;
+  events.PushBack(ProfileEvent{"say \"hi\"", 1500, 4000, 2});
+  std::string trace = Profiler::ToChromeTrace(events);
+  EXPECT_NE(trace.find("\"traceEvents\":["), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"say \\\"hi\\\"\""), std::string::npos);
+  EXPECT_NE(trace.find("\"ts\":1.500,\"dur\":2.500"), std::string::npos);
+  EXPECT_NE(trace.find("\"tid\":2"), std::string::npos);
+}
+
+TEST(ProfilerTests, TaskNames) {
+  NamedTask named;
+  EXPECT_NE(std::string(named.Name()).find("NamedTask"), std::string::npos);
+  EXPECT_EQ(named.Name(), named.Name());
+  EXPECT_STREQ(LabeledTask().Name(), "Labeled");
+
+#if defined(PIGEON_PROFILE)
+  Profiler::Collect();
+  SerialTasks tasks;
+  tasks.Push(Owned<LabeledTask>::New());
+  tasks.Push(Owned<LabeledTask>::New());
+  tasks.Execute();
+  EXPECT_EQ(CountNamed(Profiler::Collect(), "Labeled"), 2);
+#endif
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/base/auto_ptr/owned.hpp"
+#include "pigeon_framework/base/container/ring_buffer.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+template <typename Ring>
+void ExpectFifo() {
+  Ring ring(5);
+  EXPECT_EQ(ring.Capacity(), 8);
+  EXPECT_TRUE(ring.IsEmpty());
+  EXPECT_FALSE(ring.TryPop().has_value());
+  // Several laps, so that the indices wrap around the slots.
+  for (int32_t lap = 0; lap < 3; ++lap) {
+    for (int32_t i = 0; i < 8; ++i) {
+      EXPECT_TRUE(ring.TryPush(Owned<int32_t>::New(lap * 8 + i)));
+    }
+    EXPECT_FALSE(ring.TryEmplace(Owned<int32_t>::New(-1)));
+    EXPECT_EQ(ring.Size(), 8);
+    for (int32_t i = 0; i < 8; ++i) {
+      auto val = ring.TryPop();
+      ASSERT_TRUE(val.has_value());
+      EXPECT_EQ(**val, lap * 8 + i);
+    }
+    EXPECT_TRUE(ring.IsEmpty());
+  }
+}
+
+template <typename Ring>
+void ExpectBatch() {
+  Ring ring(8);
+  std::vector<Owned<int32_t>> items;
+  for (int32_t i = 0; i < 10; ++i) {
+    items.push_back(Owned<int32_t>::New(i));
+  }
+  EXPECT_EQ(ring.PushBatch(std::span(items.data(), 3)), 3);
+  EXPECT_EQ(ring.PushBatch(std::span(items.data() + 3, 7)), 5);
+  EXPECT_TRUE(items[0].IsNull());
+  EXPECT_FALSE(items[8].IsNull());
+
+  std::vector<int32_t> popped;
+  auto sink = [&popped](Owned<int32_t>&& item) { popped.push_back(*item); };
+  EXPECT_EQ(ring.PopBatch(sink, 6), 6);
+  EXPECT_EQ(ring.PushBatch(std::span(items.data() + 8, 2)), 2);
+  EXPECT_EQ(ring.PopBatch(sink), 4);
+  EXPECT_EQ(popped, std::vector<int32_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+struct Counted {
+  explicit Counted(std::atomic_int32_t* alive) : alive_(alive) { ++*alive_; }
+  Counted(Counted&& other) noexcept : alive_(other.alive_) { ++*alive_; }
+  Counted& operator=(Counted&& other) noexcept = default;
+  ~Counted() { --*alive_; }
+
+  std::atomic_int32_t* alive_;
+};
+
+template <typename Ring>
+void ExpectDestroy() {
+  std::atomic_int32_t alive = 0;
+  {
+    Ring ring(4);
+    for (int32_t i = 0; i < 6; ++i) {
+      ring.TryEmplace(&alive);
+      if (i % 2 == 0) {
+        ring.TryPop();
+      }
+    }
+    EXPECT_EQ(alive, 3);
+  }
+  EXPECT_EQ(alive, 0);
+}
+
+struct Fragile {
+  explicit Fragile(int32_t val, bool fail = false) : val_(val), fail_(fail) {}
+  Fragile(const Fragile& other) : val_(other.val_), fail_(other.fail_) {
+    if (fail_) {
+      throw std::runtime_error("Copy failed.");
+    }
+  }
+  Fragile(Fragile&& other) noexcept = default;
+  Fragile& operator=(const Fragile& other) = default;
+  Fragile& operator=(Fragile&& other) noexcept = default;
+
+  int32_t val_;
+  bool fail_;
+};
+
+// A copy that throws leaves the ring as it was.
+template <typename Ring>
+void ExpectThrowingCopy() {
+  Ring ring(2);
+  Fragile bad(0, true);
+  EXPECT_THROW(ring.TryPush(bad), std::runtime_error);
+  EXPECT_THROW(ring.TryEmplace(bad), std::runtime_error);
+  Fragile good(1);
+  EXPECT_TRUE(ring.TryPush(good));
+  EXPECT_TRUE(ring.TryEmplace(2));
+  EXPECT_EQ(ring.TryPop()->val_, 1);
+  EXPECT_EQ(ring.TryPop()->val_, 2);
+  EXPECT_TRUE(ring.IsEmpty());
+}
+
+}  // namespace
+
+TEST(RingBufferTests, SpscFifo) {
+  ExpectFifo<SpscRingBuffer<Owned<int32_t>>>();
+  ExpectBatch<SpscRingBuffer<Owned<int32_t>>>();
+  ExpectDestroy<SpscRingBuffer<Counted>>();
+  ExpectThrowingCopy<SpscRingBuffer<Fragile>>();
+}
+
+TEST(RingBufferTests, MpmcFifo) {
+  ExpectFifo<MpmcRingBuffer<Owned<int32_t>>>();
+  ExpectBatch<MpmcRingBuffer<Owned<int32_t>>>();
+  ExpectDestroy<MpmcRingBuffer<Counted>>();
+  ExpectThrowingCopy<MpmcRingBuffer<Fragile>>();
+}
+
+// Threads yield on a full or empty ring, so the tests stay quick when there
+// are fewer cores than threads.
+TEST(RingBufferTests, SpscThreads) {
+  constexpr uint64_t kItemCnt = 100000;
+  SpscRingBuffer<uint64_t> ring(64);
+  std::thread producer([&ring] {
+    uint64_t next = 0;
+    uint64_t batch[16];
+    while (next < kItemCnt) {
+      size_t pushed;
+      if (next % 3 == 0) {
+        pushed = ring.TryPush(next);
+      } else {
+        size_t cnt = std::min<uint64_t>(16, kItemCnt - next);
+        for (size_t i = 0; i < cnt; ++i) {
+          batch[i] = next + i;
+        }
+        pushed = ring.PushBatch(std::span(batch, cnt));
+      }
+      if (pushed == 0) {
+        std::this_thread::yield();
+      }
+      next += pushed;
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kItemCnt) {
+    size_t popped = ring.PopBatch([&expected](uint64_t&& item) {
+      EXPECT_EQ(item, expected);
+      ++expected;
+    });
+    if (popped == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(ring.IsEmpty());
+}
+
+TEST(RingBufferTests, MpmcThreads) {
+  constexpr uint64_t kThreadCnt = 4;
+  constexpr uint64_t kItemCnt = 20000;
+  MpmcRingBuffer<uint64_t> ring(128);
+  std::atomic_uint64_t sum = 0;
+  std::atomic_uint64_t popped = 0;
+
+  std::vector<std::thread> threads;
+  for (uint64_t t = 0; t < kThreadCnt; ++t) {
+    threads.emplace_back([&ring, t] {
+      uint64_t batch[8];
+      for (uint64_t i = 1; i <= kItemCnt;) {
+        size_t pushed;
+        if (t % 2 == 0) {
+          pushed = ring.TryPush(i);
+        } else {
+          size_t cnt = std::min<uint64_t>(8, kItemCnt - i + 1);
+          for (size_t j = 0; j < cnt; ++j) {
+            batch[j] = i + j;
+          }
+          pushed = ring.PushBatch(std::span(batch, cnt));
+        }
+        if (pushed == 0) {
+          std::this_thread::yield();
+        }
+        i += pushed;
+      }
+    });
+    threads.emplace_back([&ring, &sum, &popped, t] {
+      while (popped.load() < kThreadCnt * kItemCnt) {
+        size_t cnt = 0;
+        if (t % 2 == 0) {
+          if (auto item = ring.TryPop()) {
+            sum += *item;
+            ++popped;
+            cnt = 1;
+          }
+        } else {
+          cnt = ring.PopBatch(
+              [&sum, &popped](uint64_t&& item) {
+                sum += item;
+                ++popped;
+              },
+              4);
+        }
+        if (cnt == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(sum, kThreadCnt * kItemCnt * (kItemCnt + 1) / 2);
+  EXPECT_TRUE(ring.IsEmpty());
+}
@@ -0,0 +1,462 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "pigeon_framework/base/container/work_stealing_deque.hpp"
+#include "pigeon_framework/task/co_task.hpp"
+#include "pigeon_framework/task/parallel_tasks.hpp"
+#include "pigeon_framework/task/serial_tasks.hpp"
+#include "pigeon_framework/task/task_graph.hpp"
+#include "pigeon_framework/task/waker.hpp"
+#include "pigeon_framework/task/worker_pool.hpp"
+#include "pigeon_framework/task/task_arena.hpp"
+
+using namespace pigeon;
+
+namespace {
+
+class CountdownTask : public Task {
+ public:
+  CountdownTask(int32_t cnt, std::atomic_int32_t* executed)
+      : cnt_(cnt), executed_(executed) {}
+
+  Status Execute() override {
+    executed_->fetch_add(1, std::memory_order_relaxed);
+    return --cnt_ > 0 ? Status::Keep : Status::Done;
+  }
+
+ private:
+  int32_t cnt_;
+  std::atomic_int32_t* executed_;
+};
+
+
+// Records the order tasks finished in, to check it against the dependencies.
+class OrderTask : public Task {
+ public:
+  OrderTask(int32_t id, std::atomic_int32_t* clock, int32_t* finished_at)
+      : id_(id), clock_(clock), finished_at_(finished_at) {}
+
+  Status Execute() override {
+    std::this_thread::sleep_for(std::chrono::microseconds(id_ % 7 * 50));
+    finished_at_[id_] = clock_->fetch_add(1);
+    return Status::Keep;
+  }
+
+ private:
+  int32_t id_;
+  std::atomic_int32_t* clock_;
+  int32_t* finished_at_;
+};
+
+
+CoTask CountFrames(int32_t frame_cnt, int32_t* counter) {
+  for (int32_t i = 0; i < frame_cnt; ++i) {
+    ++*counter;
+    co_await CoTask::NextFrame();
+  }
+}
+
+CoTask Throw() {
+  co_await CoTask::NextFrame();
+  throw std::runtime_error("Thrown from the coroutine.");
+}
+
+
+// Parks `park_cnt` times, leaving its waker in `waker`, then finishes.
+class ParkTask : public Task {
+ public:
+  ParkTask(int32_t park_cnt, Waker* waker, std::atomic_int32_t* executed)
+      : park_cnt_(park_cnt), waker_(waker), executed_(executed) {}
+
+  Status Execute() override {
+    executed_->fetch_add(1, std::memory_order_relaxed);
+    if (park_cnt_-- == 0) {
+      return Status::Done;
+    }
+    *waker_ = Waker::Current();
+    return Status::Park;
+  }
+
+ private:
+  int32_t park_cnt_;
+  Waker* waker_;
+  std::atomic_int32_t* executed_;
+};
+
+}  // namespace
+
+TEST(TaskTests, SerialTasks) {
+  std::atomic_int32_t executed = 0;
+  SerialTasks tasks;
+  tasks.Push(Owned<CountdownTask>::New(1, &executed));
+  tasks.Push(Owned<CountdownTask>::New(2, &executed));
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.Size(), 1);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, 3);
+}
+
+TEST(TaskTests, WorkStealingDeque) {
+  WorkStealingDeque<size_t> deque(2);
+  constexpr size_t kItemCnt = 100000;
+  std::atomic_size_t sum = 0;
+  std::atomic_size_t taken = 0;
+
+  std::vector<std::thread> thieves;
+  for (int32_t i = 0; i < 3; ++i) {
+    thieves.emplace_back([&] {
+      while (taken.load() < kItemCnt) {
+        if (auto item = deque.Steal()) {
+          sum += *item;
+          ++taken;
+        }
+      }
+    });
+  }
+  for (size_t i = 1; i <= kItemCnt; ++i) {
+    deque.Push(i);
+    if (i % 3 == 0) {
+      if (auto item = deque.Pop()) {
+        sum += *item;
+        ++taken;
+      }
+    }
+  }
+  while (auto item = deque.Pop()) {
+    sum += *item;
+    ++taken;
+  }
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+  EXPECT_EQ(sum, kItemCnt * (kItemCnt + 1) / 2);
+  EXPECT_TRUE(deque.IsEmpty());
+}
+
+TEST(TaskTests, ParallelTasks) {
+  std::atomic_int32_t executed = 0;
+  ParallelTasks tasks(4);
+  EXPECT_EQ(tasks.ThreadCnt(), 4);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+
+  int32_t expected = 0;
+  for (int32_t i = 0; i < 1000; ++i) {
+    tasks.Push(Owned<CountdownTask>::New(i % 3 + 1, &executed));
+    expected += i % 3 + 1;
+  }
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.Size(), 666);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.Size(), 333);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, expected);
+}
+
+TEST(TaskTests, ParallelTasksSingleThread) {
+  std::atomic_int32_t executed = 0;
+  ParallelTasks tasks(1);
+  tasks.Push(Owned<CountdownTask>::New(2, &executed));
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, 2);
+}
+
+TEST(TaskTests, WorkerPoolParksIdle) {
+  WorkerPool pool(4);
+  std::atomic_int32_t executed = 0;
+  // Item 0 is slow, then pushes more items for the sleeping workers.
+  auto run = [&pool, &executed](size_t index, size_t worker) {
+    if (index == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      for (size_t i = 1; i <= 6; ++i) {
+        pool.Push(worker, i);
+      }
+    }
+    executed.fetch_add(1, std::memory_order_relaxed);
+  };
+  pool.Seed(0);
+  std::clock_t start = std::clock();
+  pool.Run(7, run);
+  double cpu_ms = 1000.0 * (std::clock() - start) / CLOCKS_PER_SEC;
+  EXPECT_EQ(executed, 7);
+  // Spinning workers would burn at least the 200ms the slow item took.
+  EXPECT_LT(cpu_ms, 100);
+}
+
+TEST(TaskTests, TaskArenaSteadyState) {
+  std::atomic_int32_t executed = 0;
+  SerialTasks tasks;
+  auto tick = [&tasks, &executed] {
+    for (int32_t i = 0; i < 100; ++i) {
+      tasks.Push(Owned<CountdownTask>::New(1, &executed));
+    }
+    tasks.Execute();
+  };
+
+  tick();
+  size_t slab_cnt = TaskArena::SlabCnt();
+  EXPECT_GT(slab_cnt, 0);
+  for (int32_t i = 0; i < 100; ++i) {
+    tick();
+  }
+  EXPECT_EQ(TaskArena::SlabCnt(), slab_cnt);
+  EXPECT_EQ(executed, 10100);
+}
+
+TEST(TaskTests, TaskArenaCrossThread) {
+  std::atomic_int32_t executed = 0;
+  std::vector<Owned<Task>> tasks;
+  for (int32_t i = 0; i < 1000; ++i) {
+    tasks.push_back(Owned<CountdownTask>::New(1, &executed));
+  }
+  std::thread([&tasks] { tasks.clear(); }).join();
+
+  struct alignas(64) AlignedTask : public Task {
+    Status Execute() override { return Status::Done; }
+  };
+  auto aligned = Owned<AlignedTask>::New();
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned.Get()) % 64, 0);
+
+  void* large = TaskArena::Allocate(TaskArena::kMaxBlockSize + 1);
+  TaskArena::Deallocate(large, TaskArena::kMaxBlockSize + 1);
+}
+
+TEST(TaskTests, TaskGraph) {
+  // Diamond per layer: a -> (b, c) -> d -> next layer.
+  constexpr int32_t kLayerCnt = 20;
+  std::atomic_int32_t clock = 0;
+  int32_t finished_at[kLayerCnt * 4];
+  TaskGraph graph(4);
+  TaskGraph::NodeId previous = 0;
+  for (int32_t layer = 0; layer < kLayerCnt; ++layer) {
+    auto task = [&](int32_t id) {
+      return Owned<OrderTask>::New(id, &clock, finished_at);
+    };
+    TaskGraph::NodeId a = layer == 0 ? graph.Add(task(0))
+                                     : graph.Add(task(layer * 4), {previous});
+    TaskGraph::NodeId b = graph.Add(task(layer * 4 + 1), {a});
+    TaskGraph::NodeId c = graph.Add(task(layer * 4 + 2), {a});
+    previous = graph.Add(task(layer * 4 + 3), {b, c});
+  }
+  EXPECT_EQ(graph.Size(), kLayerCnt * 4);
+  EXPECT_THROW(graph.Add(Owned<OrderTask>::New(0, &clock, finished_at), {999}),
+               std::out_of_range);
+
+  for (int32_t frame = 0; frame < 3; ++frame) {
+    clock = 0;
+    EXPECT_EQ(graph.Execute(), Task::Status::Keep);
+    for (int32_t layer = 0; layer < kLayerCnt; ++layer) {
+      int32_t* order = finished_at + layer * 4;
+      if (layer > 0) {
+        EXPECT_LT(order[-1], order[0]);
+      }
+      EXPECT_LT(order[0], order[1]);
+      EXPECT_LT(order[0], order[2]);
+      EXPECT_LT(order[1], order[3]);
+      EXPECT_LT(order[2], order[3]);
+    }
+  }
+
+  auto path = graph.LastCriticalPath();
+  EXPECT_EQ(path.nodes_.Size(), kLayerCnt * 3);
+  EXPECT_EQ(path.nodes_[0], 0);
+  EXPECT_EQ(path.nodes_[path.nodes_.Size() - 1], graph.Size() - 1);
+  EXPECT_GT(path.length_.count(), 0);
+  EXPECT_GE(path.work_, path.length_);
+}
+
+TEST(TaskTests, TaskGraphDone) {
+  std::atomic_int32_t executed = 0;
+  TaskGraph graph(2);
+  EXPECT_EQ(graph.Execute(), Task::Status::Done);
+  auto root = graph.Add(Owned<CountdownTask>::New(1, &executed));
+  graph.Add(Owned<CountdownTask>::New(3, &executed), {root});
+  EXPECT_EQ(graph.Execute(), Task::Status::Keep);
+  EXPECT_EQ(graph.Execute(), Task::Status::Keep);
+  EXPECT_EQ(graph.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, 4);
+}
+
+TEST(TaskTests, CoTask) {
+  std::atomic_int32_t executed = 0;
+  int32_t counter = 0;
+  std::vector<int32_t> steps;
+  auto run = [&]() -> CoTask {
+    steps.push_back(0);
+    co_await CountFrames(2, &counter);
+    steps.push_back(1);
+    co_await Owned<Task>(Owned<CountdownTask>::New(2, &executed));
+    steps.push_back(2);
+    co_await CoTask::WaitFor(std::chrono::milliseconds(-1));
+    steps.push_back(3);
+    co_await CoTask::WaitFor(std::chrono::hours(1));
+    steps.push_back(4);
+  };
+
+  SerialTasks tasks;
+  tasks.Push(Owned<CoTask>::New(run()));
+  EXPECT_TRUE(steps.empty());
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(steps, std::vector<int32_t>({0}));
+  EXPECT_EQ(counter, 1);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(counter, 2);
+  // Finishing the awaited coroutine resumes the caller in the same Execute.
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(steps, std::vector<int32_t>({0, 1}));
+  EXPECT_EQ(executed, 1);
+  // An expired timer doesn't cost a frame either.
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(steps, std::vector<int32_t>({0, 1, 2, 3}));
+  EXPECT_EQ(executed, 2);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(steps.size(), 4);
+  // Destroying a suspended coroutine frees its frame.
+}
+
+TEST(TaskTests, CoTaskTimerParks) {
+  auto deadline = CoTask::Clock::now() + std::chrono::milliseconds(50);
+  bool resumed = false;
+  auto run = [&]() -> CoTask {
+    co_await CoTask::WaitUntil(deadline);
+    resumed = true;
+  };
+
+  TimerWheel wheel;
+  TimerWheelScope scope(&wheel);
+  ParallelTasks tasks(2);
+  tasks.Push(Owned<CoTask>::New(run()));
+  // Waiting costs nothing per tick, the wheel wakes the coroutine.
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(tasks.ParkedCnt(), 1);
+  wheel.Advance(CoTask::Clock::now());
+  EXPECT_EQ(wheel.Size(), 1);
+  std::this_thread::sleep_until(deadline);
+  wheel.Advance(CoTask::Clock::now());
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_TRUE(resumed);
+}
+
+TEST(TaskTests, CoTaskException) {
+  CoTask task = Throw();
+  EXPECT_EQ(task.Execute(), Task::Status::Keep);
+  EXPECT_THROW(task.Execute(), std::runtime_error);
+  EXPECT_TRUE(task.IsDone());
+  EXPECT_EQ(task.Execute(), Task::Status::Done);
+
+  CoTask moved = CountFrames(1, nullptr);
+  CoTask target = std::move(moved);
+  EXPECT_TRUE(moved.IsDone());
+  EXPECT_FALSE(target.IsDone());
+}
+
+TEST(TaskTests, SerialTasksPark) {
+  std::atomic_int32_t executed = 0;
+  std::vector<Waker> wakers(100);
+  SerialTasks tasks;
+  for (auto& waker : wakers) {
+    tasks.Push(Owned<ParkTask>::New(1, &waker, &executed));
+  }
+  tasks.Push(Owned<CountdownTask>::New(3, &executed));
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.Size(), 1);
+  EXPECT_EQ(tasks.ParkedCnt(), 100);
+  // Parked tasks are not executed.
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(executed, 102);
+
+  std::thread([&wakers] {
+    for (size_t i = 0; i < wakers.size(); i += 2) {
+      wakers[i].Wake();
+      wakers[i].Wake();
+    }
+  }).join();
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 153);
+  EXPECT_EQ(tasks.ParkedCnt(), 50);
+
+  // Wakers of finished tasks do nothing.
+  wakers[0].Wake();
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 153);
+
+  // A task nobody can wake any more is dropped.
+  for (size_t i = 1; i < wakers.size(); i += 2) {
+    wakers[i] = Waker();
+  }
+  EXPECT_EQ(tasks.ParkedCnt(), 0);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+}
+
+TEST(TaskTests, ParkWokenWhileRunning) {
+  class SelfWakeTask : public Task {
+   public:
+    Status Execute() override {
+      if (++executed_ == 2) {
+        return Status::Done;
+      }
+      Waker::Current().Wake();
+      return Status::Park;
+    }
+
+    int32_t executed_{0};
+  };
+
+  EXPECT_TRUE(Waker::Current().IsNull());
+  SerialTasks tasks;
+  tasks.Push(Owned<SelfWakeTask>::New());
+  EXPECT_EQ(tasks.Execute(), Task::Status::Keep);
+  EXPECT_EQ(tasks.ParkedCnt(), 0);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+}
+
+TEST(TaskTests, NestedPark) {
+  std::atomic_int32_t executed = 0;
+  Waker inner_waker;
+  Waker parallel_waker;
+  auto inner = Owned<SerialTasks>::New();
+  inner->Push(Owned<ParkTask>::New(1, &inner_waker, &executed));
+  auto parallel = Owned<ParallelTasks>::New(2);
+  parallel->Push(Owned<ParkTask>::New(1, &parallel_waker, &executed));
+  SerialTasks outer;
+  outer.Push(std::move(inner));
+  outer.Push(std::move(parallel));
+
+  // Both inner executors park themselves along with their only task.
+  EXPECT_EQ(outer.Execute(), Task::Status::Park);
+  EXPECT_EQ(outer.ParkedCnt(), 2);
+  EXPECT_EQ(outer.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 2);
+
+  inner_waker.Wake();
+  EXPECT_EQ(outer.ParkedCnt(), 1);
+  EXPECT_EQ(outer.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 3);
+  parallel_waker.Wake();
+  EXPECT_EQ(outer.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, 4);
+}
+
+TEST(TaskTests, CoTaskPark) {
+  Waker waker;
+  int32_t step = 0;
+  auto run = [&]() -> CoTask {
+    waker = Waker::Current();
+    step = 1;
+    co_await CoTask::Park();
+    step = 2;
+  };
+
+  SerialTasks tasks;
+  tasks.Push(Owned<CoTask>::New(run()));
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(step, 1);
+  waker.Wake();
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_EQ(step, 2);
+}
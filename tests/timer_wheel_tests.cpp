@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "pigeon_framework/task/serial_tasks.hpp"
+#include "pigeon_framework/task/timer_wheel.hpp"
+
+using namespace pigeon;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = TimerWheel::Clock;
+
+// Records the wheel time it fired at, and keeps going `repeat` times.
+class FireTask : public Task {
+ public:
+  FireTask(const TimerWheel* wheel, std::vector<Clock::time_point>* fired,
+           int32_t repeat = 0)
+      : wheel_(wheel), fired_(fired), repeat_(repeat) {}
+
+  Status Execute() override {
+    fired_->push_back(wheel_->Now());
+    return repeat_-- > 0 ? Status::Keep : Status::Done;
+  }
+
+ private:
+  const TimerWheel* wheel_;
+  std::vector<Clock::time_point>* fired_;
+  int32_t repeat_;
+};
+
+}  // namespace
+
+TEST(TimerWheelTests, OneShot) {
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  std::vector<Clock::time_point> fired;
+  wheel.At(start + 10ms, Owned<FireTask>::New(&wheel, &fired));
+  wheel.After(5500us, Owned<FireTask>::New(&wheel, &fired));
+  EXPECT_EQ(wheel.Size(), 2);
+
+  wheel.Advance(start + 5ms);
+  EXPECT_TRUE(fired.empty());
+  // Rounded up to the next tick.
+  wheel.Advance(start + 6ms);
+  EXPECT_EQ(fired.size(), 1);
+  wheel.Advance(start + 9999us);
+  EXPECT_EQ(fired.size(), 1);
+  wheel.Advance(start + 10ms);
+  EXPECT_EQ(fired.size(), 2);
+  EXPECT_EQ(wheel.Size(), 0);
+
+  // Deadlines in the past fire on the next tick.
+  wheel.At(start, Owned<FireTask>::New(&wheel, &fired));
+  wheel.Advance(start + 10500us);
+  EXPECT_EQ(fired.size(), 2);
+  wheel.Advance(start + 11ms);
+  EXPECT_EQ(fired.size(), 3);
+}
+
+TEST(TimerWheelTests, Cancel) {
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  std::vector<Clock::time_point> fired;
+  auto first = wheel.After(10ms, Owned<FireTask>::New(&wheel, &fired));
+  auto second = wheel.After(10ms, Owned<FireTask>::New(&wheel, &fired));
+  auto far = wheel.After(1h, Owned<FireTask>::New(&wheel, &fired));
+  EXPECT_TRUE(wheel.Cancel(first));
+  EXPECT_FALSE(wheel.Cancel(first));
+  EXPECT_TRUE(wheel.Cancel(far));
+  EXPECT_EQ(wheel.Size(), 1);
+
+  wheel.Advance(start + 20ms);
+  EXPECT_EQ(fired.size(), 1);
+  EXPECT_FALSE(wheel.Cancel(second));
+
+  // Ids of freed timers stay stale when the slot is reused.
+  auto reused = wheel.After(10ms, Owned<FireTask>::New(&wheel, &fired));
+  EXPECT_NE(reused, first);
+  EXPECT_NE(reused, second);
+  EXPECT_FALSE(wheel.Cancel(second));
+  EXPECT_TRUE(wheel.Cancel(reused));
+}
+
+TEST(TimerWheelTests, Periodic) {
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  std::vector<Clock::time_point> fired;
+  auto id = wheel.Every(10ms, Owned<FireTask>::New(&wheel, &fired, 100));
+  for (int32_t i = 1; i <= 5; ++i) {
+    wheel.Advance(start + i * 10ms);
+  }
+  EXPECT_EQ(fired.size(), 5);
+  EXPECT_EQ(fired[4] - start, 50ms);
+
+  // Missed periods are not caught up, but the phase is kept.
+  wheel.Advance(start + 95ms);
+  EXPECT_EQ(fired.size(), 6);
+  wheel.Advance(start + 99ms);
+  EXPECT_EQ(fired.size(), 6);
+  wheel.Advance(start + 100ms);
+  EXPECT_EQ(fired.size(), 7);
+
+  EXPECT_TRUE(wheel.Cancel(id));
+  wheel.Advance(start + 200ms);
+  EXPECT_EQ(fired.size(), 7);
+}
+
+TEST(TimerWheelTests, Levels) {
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  std::mt19937_64 random(42);
+  std::vector<Clock::time_point> fired;
+  std::vector<Clock::time_point> deadlines;
+  for (int32_t i = 0; i < 2000; ++i) {
+    auto delay = std::chrono::milliseconds(random() % (1 << 22) + 1);
+    deadlines.push_back(start + delay);
+    wheel.At(start + delay, Owned<FireTask>::New(&wheel, &fired));
+  }
+  auto now = start;
+  while (wheel.Size() != 0) {
+    now += std::chrono::milliseconds(random() % 5000 + 1);
+    size_t fired_cnt = fired.size();
+    wheel.Advance(now);
+    for (size_t i = fired_cnt; i < fired.size(); ++i) {
+      EXPECT_EQ(fired[i], now);
+    }
+  }
+  EXPECT_EQ(fired.size(), deadlines.size());
+
+  // Never early, and never later than the Advance after the deadline.
+  std::sort(deadlines.begin(), deadlines.end());
+  for (size_t i = 0; i < deadlines.size(); ++i) {
+    EXPECT_GE(fired[i], deadlines[i]);
+    EXPECT_LE(fired[i], deadlines[i] + 5000ms);
+  }
+}
+
+TEST(TimerWheelTests, BeyondRange) {
+  auto start = Clock::now();
+  TimerWheel wheel(1ns, 1, start);
+  std::vector<Clock::time_point> fired;
+  auto delay = std::chrono::nanoseconds(uint64_t{1} << 34);
+  wheel.After(delay, Owned<FireTask>::New(&wheel, &fired));
+  wheel.Advance(start + delay - 1ns);
+  EXPECT_TRUE(fired.empty());
+  wheel.Advance(start + delay);
+  EXPECT_EQ(fired.size(), 1);
+}
+
+TEST(TimerWheelTests, WakeParkedTask) {
+  class SleepTask : public Task {
+   public:
+    SleepTask(TimerWheel* wheel, int32_t* executed)
+        : wheel_(wheel), executed_(executed) {}
+
+    Status Execute() override {
+      if (++*executed_ == 3) {
+        return Status::Done;
+      }
+      wheel_->WakeAfter(10ms, Waker::Current());
+      return Status::Park;
+    }
+
+   private:
+    TimerWheel* wheel_;
+    int32_t* executed_;
+  };
+
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  int32_t executed = 0;
+  SerialTasks tasks;
+  tasks.Push(Owned<SleepTask>::New(&wheel, &executed));
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  wheel.Advance(start + 9ms);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 1);
+  wheel.Advance(start + 10ms);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Park);
+  EXPECT_EQ(executed, 2);
+  wheel.Advance(start + 20ms);
+  EXPECT_EQ(tasks.Execute(), Task::Status::Done);
+  EXPECT_EQ(executed, 3);
+}
+
+TEST(TimerWheelTests, ParkedTimerTask) {
+  class ParkTask : public Task {
+   public:
+    ParkTask(Waker* waker, int32_t* executed)
+        : waker_(waker), executed_(executed) {}
+
+    Status Execute() override {
+      if (++*executed_ == 2) {
+        return Status::Done;
+      }
+      *waker_ = Waker::Current();
+      return Status::Park;
+    }
+
+   private:
+    Waker* waker_;
+    int32_t* executed_;
+  };
+
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 1, start);
+  Waker waker;
+  int32_t executed = 0;
+  wheel.Every(5ms, Owned<ParkTask>::New(&waker, &executed));
+  wheel.Advance(start + 5ms);
+  EXPECT_EQ(executed, 1);
+  EXPECT_FALSE(waker.IsNull());
+  EXPECT_EQ(wheel.Size(), 0);
+
+  // Parked, so the period no longer applies.
+  wheel.Advance(start + 20ms);
+  EXPECT_EQ(executed, 1);
+  waker.Wake();
+  wheel.Advance(start + 21ms);
+  EXPECT_EQ(executed, 2);
+  EXPECT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimerWheelTests, ParallelBatch) {
+  class CountTask : public Task {
+   public:
+    explicit CountTask(std::atomic_int32_t* executed) : executed_(executed) {}
+
+    Status Execute() override {
+      executed_->fetch_add(1, std::memory_order_relaxed);
+      return Status::Done;
+    }
+
+   private:
+    std::atomic_int32_t* executed_;
+  };
+
+  auto start = Clock::now();
+  TimerWheel wheel(1ms, 4, start);
+  EXPECT_EQ(wheel.ThreadCnt(), 4);
+  std::atomic_int32_t executed = 0;
+  for (int32_t i = 0; i < 10000; ++i) {
+    wheel.After(std::chrono::milliseconds(i % 100),
+                Owned<CountTask>::New(&executed));
+  }
+  wheel.Advance(start + 50ms);
+  EXPECT_EQ(executed, 5100);
+  wheel.Advance(start + 100ms);
+  EXPECT_EQ(executed, 10000);
+  EXPECT_EQ(wheel.Size(), 0);
+}
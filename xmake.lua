@@ -15,12 +15,35 @@ option("examples")
   set_description("Enable examples")
 option_end()
 
+option("bench")
+  set_default(false)
+  set_description("Enable benchmarks")
+option_end()
+
+option("profile")
+  set_default(false)
+  set_description("Record profile zones and task timings")
+option_end()
+
+option("track_memory")
+  set_default(false)
+  set_description("Count heap allocations per memory tag")
+option_end()
+
 add_rules("mode.debug", "mode.release")
 
 if is_config("kind", "shared") then
   add_defines("PIGEON_SHARED")
 end
 
+if has_config("profile") then
+  add_defines("PIGEON_PROFILE")
+end
+
+if has_config("track_memory") then
+  add_defines("PIGEON_TRACK_MEMORY")
+end
+
 target("pigeon_engine")
   add_defines("BUILD_PIGEON")
   set_kind(get_config("kind"))
@@ -89,3 +112,58 @@ task("test")
     description = "Run all unittest"
   }
 task_end()
+
+if get_config("bench") == true then
+  includes("packages/benchmark.lua")
+  add_requires("benchmark 1.8.3", {configs = {main = true}})
+  for _, file in ipairs(os.files("benchmarks/*.cpp")) do
+    target("bench." .. path.basename(file))
+      set_kind("binary")
+      set_group("bench")
+      set_targetdir("build/benchmarks")
+      add_files(file)
+      add_deps("pigeon_engine")
+      add_packages("benchmark")
+      if is_plat("windows") then
+        add_ldflags("/subsystem:console")
+      end
+    target_end()
+  end
+end
+
+task("bench")
+  on_run(function ()
+    import("core.base.option")
+    local outdir = path.absolute(option.get("outdir"))
+    os.mkdir(outdir)
+    os.exec("xmake config -m release --test=no --examples=no --bench=yes " ..
+            "--kind=shared")
+    os.exec("xmake build -g bench")
+    for _, file in ipairs(os.files("benchmarks/*.cpp")) do
+      local name = path.basename(file)
+      local args = {
+        "--benchmark_out=" .. path.join(outdir, name .. ".json"),
+        "--benchmark_out_format=json"
+      }
+      local filter = option.get("filter")
+      if filter then
+        table.insert(args, "--benchmark_filter=" .. filter)
+      end
+      os.execv("xmake", table.join({"run", "bench." .. name}, args))
+    end
+  end)
+  set_menu {
+    usage = "xmake bench [options]",
+    description = "Run all benchmarks and write their results as JSON",
+    options = {
+      {
+        "o", "outdir", "kv", "build/benchmarks/results",
+        "Set the directory for the JSON results."
+      },
+      {
+        "f", "filter", "kv", nil,
+        "Only run benchmarks matching the regex."
+      }
+    }
+  }
+task_end()